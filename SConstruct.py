@@ -22,4 +22,13 @@ else:
         source=sources,
     )
 
-Default(library)
\ No newline at end of file
+Default(library)
+
+# Stand-in evaluation worker for NEATAgent.start_evaluation_workers (POSIX only, plain C++ so no godot-cpp link)
+if env["platform"] in ["linux", "macos"]:
+    worker_env = env.Clone(LIBS=[])
+    worker = worker_env.Program(
+        "addons/NEAT/bin/neat_stand_in_worker{}".format(env["suffix"]),
+        source=["tools/neat_stand_in_worker.cpp"],
+    )
+    Default(worker)
\ No newline at end of file
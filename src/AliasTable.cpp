@@ -0,0 +1,59 @@
+#include "AliasTable.h"
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <random>
+
+void AliasTable::build(const std::vector<float> &weights){
+    int n = weights.size();
+    this->probability.assign(n, 1.0f);
+    this->alias.resize(n);
+    for (int i = 0; i < n; i++) this->alias[i] = i;
+
+    double total = 0.0;
+    for (float w : weights) total += std::max(w, 0.0f);
+    if (n == 0 || total <= 0.0) return;
+
+    //Scale so the mean weight is 1, then pair each under full column with an over full one
+    this->scaled.resize(n);
+    this->small.clear();
+    this->large.clear();
+    for (int i = 0; i < n; i++){
+        this->scaled[i] = std::max(weights[i], 0.0f) * n / total;
+        if (this->scaled[i] < 1.0) this->small.push_back(i);
+        else this->large.push_back(i);
+    }
+
+    while (!this->small.empty() && !this->large.empty()){
+        int s = this->small.back();
+        this->small.pop_back();
+        int l = this->large.back();
+
+        this->probability[s] = this->scaled[s];
+        this->alias[s] = l;
+        this->scaled[l] -= 1.0 - this->scaled[s];
+        if (this->scaled[l] < 1.0){
+            this->large.pop_back();
+            this->small.push_back(l);
+        }
+    }
+
+    //Whatever is left is 1 up to rounding error
+    for (int i : this->small) this->probability[i] = 1.0f;
+    for (int i : this->large) this->probability[i] = 1.0f;
+}
+
+void AliasTable::clear(){
+    this->probability.clear();
+    this->alias.clear();
+}
+
+int AliasTable::sample(NEATRandom &gen) const {
+    int i = std::uniform_int_distribution<>(0, this->probability.size() - 1)(gen);
+    if (this->probability[i] >= 1.0f) return i;
+    float coin = std::uniform_real_distribution<float>(0.0f, 1.0f)(gen);
+    return coin < this->probability[i] ? i : this->alias[i];
+}
+
+size_t AliasTable::get_memory_usage() const {
+    return memory_usage::vector_bytes(this->probability) + memory_usage::vector_bytes(this->alias) + memory_usage::vector_bytes(this->small) + memory_usage::vector_bytes(this->large) + memory_usage::vector_bytes(this->scaled);
+}
@@ -0,0 +1,25 @@
+#ifndef ALIASTABLE_H
+#define ALIASTABLE_H
+
+#include "Random.h"
+#include <vector>
+#include <cstddef>
+
+//Walker/Vose alias table. Building is O(n), after which each weighted draw is one uniform index and one coin flip.
+//Negative weights count as 0, and if no weight is positive every index is equally likely
+struct AliasTable {
+    void build(const std::vector<float> &weights);
+    void clear();
+    int sample(NEATRandom &gen) const;
+    int size() const { return (int)this->probability.size(); }
+    size_t get_memory_usage() const;
+
+private:
+    std::vector<float> probability; //Chance of keeping index i rather than taking alias[i]
+    std::vector<int> alias;
+    std::vector<int> small; //Build scratch, kept so rebuilding every generation doesnt allocate
+    std::vector<int> large;
+    std::vector<double> scaled;
+};
+
+#endif
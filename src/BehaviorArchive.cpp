@@ -0,0 +1,145 @@
+#include "BehaviorArchive.h"
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <cmath>
+
+const int KDTREE_LEAF_SIZE = 8;
+
+static float distance_squared(const float* a, const float* b, int dimensions){
+    float sum = 0.0f;
+    for (int d = 0; d < dimensions; d++){
+        float diff = a[d] - b[d];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+void push_nearest(std::vector<float> &heap, int k, float distance_squared){
+    if (heap.size() < k){
+        heap.push_back(distance_squared);
+        std::push_heap(heap.begin(), heap.end());
+    }
+    else if (distance_squared < heap.front()){
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = distance_squared;
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+
+void KDTree::build(const float* points, int count, int dimensions){
+    this->dimensions = dimensions;
+    this->count = count;
+    this->order.resize(count);
+    this->split_dim.assign(count, 0);
+    for (int i = 0; i < count; i++) this->order[i] = i;
+    build_range(points, 0, count);
+}
+
+void KDTree::build_range(const float* points, int lo, int hi){
+    if (hi - lo <= KDTREE_LEAF_SIZE) return;
+
+    //Split on the dimension with the widest spread
+    int best_dim = 0;
+    float best_spread = -1.0f;
+    for (int d = 0; d < this->dimensions; d++){
+        float low = points[this->order[lo] * this->dimensions + d];
+        float high = low;
+        for (int i = lo + 1; i < hi; i++){
+            float value = points[this->order[i] * this->dimensions + d];
+            low = std::min(low, value);
+            high = std::max(high, value);
+        }
+        if (high - low > best_spread){
+            best_spread = high - low;
+            best_dim = d;
+        }
+    }
+
+    int mid = (lo + hi) / 2;
+    int dims = this->dimensions;
+    std::nth_element(this->order.begin() + lo, this->order.begin() + mid, this->order.begin() + hi, [points, dims, best_dim](int a, int b) {
+        return points[a * dims + best_dim] < points[b * dims + best_dim];
+    });
+    this->split_dim[mid] = best_dim;
+
+    build_range(points, lo, mid);
+    build_range(points, mid + 1, hi);
+}
+
+void KDTree::nearest(const float* points, const float* query, int k, int exclude, std::vector<float> &heap) const {
+    if (this->count == 0) return;
+    search_range(points, 0, this->count, query, k, exclude, heap);
+}
+
+void KDTree::search_range(const float* points, int lo, int hi, const float* query, int k, int exclude, std::vector<float> &heap) const {
+    if (hi - lo <= KDTREE_LEAF_SIZE){
+        for (int i = lo; i < hi; i++){
+            int index = this->order[i];
+            if (index == exclude) continue;
+            push_nearest(heap, k, distance_squared(points + index * this->dimensions, query, this->dimensions));
+        }
+        return;
+    }
+
+    int mid = (lo + hi) / 2;
+    int index = this->order[mid];
+    int dim = this->split_dim[mid];
+    if (index != exclude) push_nearest(heap, k, distance_squared(points + index * this->dimensions, query, this->dimensions));
+
+    //Search the side the query falls on first, then the other side only if it could hold something closer
+    float diff = query[dim] - points[index * this->dimensions + dim];
+    if (diff < 0.0f){
+        search_range(points, lo, mid, query, k, exclude, heap);
+        if (heap.size() < k || diff * diff < heap.front()) search_range(points, mid + 1, hi, query, k, exclude, heap);
+    }
+    else{
+        search_range(points, mid + 1, hi, query, k, exclude, heap);
+        if (heap.size() < k || diff * diff < heap.front()) search_range(points, lo, mid, query, k, exclude, heap);
+    }
+}
+
+void BehaviorArchive::clear(int dimensions){
+    this->dimensions = dimensions;
+    this->points.clear();
+    this->indexed_count = 0;
+    this->tree = KDTree();
+}
+
+int BehaviorArchive::size() const {
+    return this->dimensions > 0 ? this->points.size() / this->dimensions : 0;
+}
+
+void BehaviorArchive::add(const float* behavior){
+    this->points.insert(this->points.end(), behavior, behavior + this->dimensions);
+}
+
+void BehaviorArchive::refresh_index(){
+    //Rebuild once the unindexed tail is big enough to slow queries down
+    int pending = size() - this->indexed_count;
+    if (pending <= std::max(64, (int)std::sqrt((float)this->indexed_count) * 4)) return;
+
+    this->tree.build(this->points.data(), size(), this->dimensions);
+    this->indexed_count = size();
+}
+
+void BehaviorArchive::trim(int max_size){
+    //Forget the oldest behaviors, with some slack so this doesnt rebuild every generation
+    if (size() <= max_size) return;
+    int keep = std::max(0, max_size - max_size / 10);
+    int drop = size() - keep;
+    this->points.erase(this->points.begin(), this->points.begin() + (size_t)drop * this->dimensions);
+
+    this->tree.build(this->points.data(), size(), this->dimensions);
+    this->indexed_count = size();
+}
+
+void BehaviorArchive::nearest(const float* query, int k, std::vector<float> &heap) const {
+    this->tree.nearest(this->points.data(), query, k, -1, heap);
+    for (int i = this->indexed_count; i < size(); i++){
+        push_nearest(heap, k, distance_squared(this->points.data() + (size_t)i * this->dimensions, query, this->dimensions));
+    }
+}
+
+size_t BehaviorArchive::get_memory_usage() const {
+    return memory_usage::vector_bytes(this->points) + memory_usage::vector_bytes(this->tree.order) + memory_usage::vector_bytes(this->tree.split_dim);
+}
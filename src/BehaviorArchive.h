@@ -0,0 +1,44 @@
+#ifndef BEHAVIORARCHIVE_H
+#define BEHAVIORARCHIVE_H
+
+#include <vector>
+#include <cstddef>
+
+//Static KD-tree over a flat array of points (count * dimensions floats). The tree only stores a permutation of point
+//indices and the split dimension of each median, the points themselves stay with the caller
+struct KDTree {
+    int dimensions = 0;
+    int count = 0;
+    std::vector<int> order;
+    std::vector<int> split_dim;
+
+    void build(const float* points, int count, int dimensions);
+    //Merges the squared distances of the k nearest points (skipping point exclude) into a max heap of at most k entries
+    void nearest(const float* points, const float* query, int k, int exclude, std::vector<float> &heap) const;
+
+private:
+    void build_range(const float* points, int lo, int hi);
+    void search_range(const float* points, int lo, int hi, const float* query, int k, int exclude, std::vector<float> &heap) const;
+};
+
+//Novelty search archive. Newly added behaviors are scanned linearly until there are enough of them to be worth rebuilding
+//the tree, which keeps inserts cheap while queries stay logarithmic in the archive size
+struct BehaviorArchive {
+    int dimensions = 0;
+    std::vector<float> points;
+    int indexed_count = 0;
+    KDTree tree;
+
+    void clear(int dimensions);
+    int size() const;
+    void add(const float* behavior);
+    void refresh_index();
+    void trim(int max_size);
+    void nearest(const float* query, int k, std::vector<float> &heap) const;
+    size_t get_memory_usage() const;
+};
+
+//Squared distance heap helper shared by the tree and the linear scan
+void push_nearest(std::vector<float> &heap, int k, float distance_squared);
+
+#endif
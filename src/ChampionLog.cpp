@@ -0,0 +1,210 @@
+#include "ChampionLog.h"
+#include <cstring>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+ChampionLogFile::~ChampionLogFile(){
+    clear();
+}
+
+uint32_t ChampionLogFile::read_u32(size_t offset) const {
+    uint32_t value;
+    std::memcpy(&value, this->base + offset, sizeof(value));
+    return value;
+}
+
+size_t ChampionLogFile::valid_size() const {
+    if (this->offsets.empty()) return champion_log::HEADER_SIZE;
+    return this->offsets.back() + read_u32(this->offsets.back());
+}
+
+int ChampionLogFile::entry_generation(int entry) const {
+    return (int)read_u32(this->offsets[entry] + 4);
+}
+
+float ChampionLogFile::entry_fitness(int entry) const {
+    float fitness;
+    std::memcpy(&fitness, this->base + this->offsets[entry] + 8, sizeof(fitness));
+    return fitness;
+}
+
+int ChampionLogFile::entry_connection_count(int entry) const {
+    return (int)read_u32(this->offsets[entry] + 12);
+}
+
+champion_log::Connection ChampionLogFile::entry_connection(int entry, int index) const {
+    champion_log::Connection connection;
+    std::memcpy(&connection, this->base + this->offsets[entry] + champion_log::RECORD_HEADER_SIZE + (size_t)index * sizeof(connection), sizeof(connection));
+    return connection;
+}
+
+#ifdef _WIN32
+
+bool ChampionLogFile::map_file(const std::string &path){
+    clear();
+    this->last_error = "Memory mapped champion logs are not supported on this platform";
+    return false;
+}
+
+void ChampionLogFile::clear(){
+    this->offsets.clear();
+}
+
+#else
+
+bool ChampionLogFile::map_file(const std::string &path){
+    clear();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        this->last_error = "Could not open champion log " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < champion_log::HEADER_SIZE){
+        ::close(fd);
+        this->last_error = "Champion log is too small to hold a header";
+        return false;
+    }
+
+    //The mapping stays valid after the descriptor is closed
+    size_t size = info.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED){
+        this->last_error = "Could not map champion log " + path;
+        return false;
+    }
+    this->base = (const uint8_t*)mapped;
+    this->mapped_size = size;
+
+    if (read_u32(0) != champion_log::MAGIC || read_u32(4) != champion_log::VERSION){
+        clear();
+        this->last_error = "Champion log has the wrong magic or version";
+        return false;
+    }
+    this->header = {read_u32(8), read_u32(12), read_u32(16), read_u32(20)};
+
+    //Step over records by their size, stopping at the first one that doesnt add up or runs past the end of the file
+    size_t offset = champion_log::HEADER_SIZE;
+    while (offset + champion_log::RECORD_HEADER_SIZE <= size){
+        size_t record_size = read_u32(offset);
+        size_t connection_count = read_u32(offset + 12);
+        if (record_size != champion_log::RECORD_HEADER_SIZE + connection_count * sizeof(champion_log::Connection) || offset + record_size > size) break;
+        this->offsets.push_back(offset);
+        offset += record_size;
+    }
+    return true;
+}
+
+void ChampionLogFile::clear(){
+    if (this->base != nullptr) munmap((void*)this->base, this->mapped_size);
+    this->base = nullptr;
+    this->mapped_size = 0;
+    this->offsets.clear();
+}
+
+#endif
+
+ChampionLogWriter::~ChampionLogWriter(){
+    close();
+}
+
+bool ChampionLogWriter::open(const std::string &path, const champion_log::Header &header){
+    close();
+
+    //An existing log is continued only if it was written for the same network shape
+    FILE* existing = fopen(path.c_str(), "rb");
+    bool has_content = existing != nullptr && fseek(existing, 0, SEEK_END) == 0 && ftell(existing) > 0;
+    if (existing != nullptr) fclose(existing);
+
+    if (has_content){
+        ChampionLogFile log;
+        if (!log.map_file(path)){
+            this->last_error = log.last_error;
+            return false;
+        }
+        if (std::memcmp(&log.header, &header, sizeof(header)) != 0){
+            this->last_error = "Existing champion log " + path + " was written for different inputs, outputs or activations";
+            return false;
+        }
+#ifndef _WIN32
+        size_t valid_size = log.valid_size();
+        log.clear();
+        if (truncate(path.c_str(), valid_size) != 0){
+            this->last_error = "Could not drop the partial record at the end of " + path;
+            return false;
+        }
+#endif
+        this->file = fopen(path.c_str(), "ab");
+    }
+    else{
+        this->file = fopen(path.c_str(), "wb");
+        if (this->file != nullptr){
+            uint32_t words[6] = {champion_log::MAGIC, champion_log::VERSION, header.inputs, header.outputs, header.hidden_function, header.output_function};
+            fwrite(words, sizeof(words), 1, this->file);
+            fflush(this->file);
+        }
+    }
+    if (this->file == nullptr){
+        this->last_error = "Could not open " + path + " for writing";
+        return false;
+    }
+
+    this->stopping = false;
+    this->writer = std::thread(&ChampionLogWriter::write_loop, this);
+    return true;
+}
+
+void ChampionLogWriter::append(int generation, float fitness, const std::vector<champion_log::Connection> &connections){
+    if (this->file == nullptr) return;
+
+    std::vector<uint8_t> record(champion_log::RECORD_HEADER_SIZE + connections.size() * sizeof(champion_log::Connection));
+    uint32_t fields[3] = {(uint32_t)record.size(), (uint32_t)generation, (uint32_t)connections.size()};
+    std::memcpy(record.data(), &fields[0], 4);
+    std::memcpy(record.data() + 4, &fields[1], 4);
+    std::memcpy(record.data() + 8, &fitness, 4);
+    std::memcpy(record.data() + 12, &fields[2], 4);
+    if (!connections.empty()) std::memcpy(record.data() + champion_log::RECORD_HEADER_SIZE, connections.data(), connections.size() * sizeof(champion_log::Connection));
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->queued.push_back(std::move(record));
+    }
+    this->wake.notify_one();
+}
+
+void ChampionLogWriter::write_loop(){
+    std::vector<std::vector<uint8_t>> writing;
+    while (true){
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->wake.wait(lock, [this]() { return this->stopping || !this->queued.empty(); });
+            if (this->queued.empty() && this->stopping) return;
+            writing.swap(this->queued);
+        }
+
+        //Whole records only reach the file in order, and each batch is flushed so readers see it
+        for (const std::vector<uint8_t> &record : writing) fwrite(record.data(), record.size(), 1, this->file);
+        fflush(this->file);
+        writing.clear();
+    }
+}
+
+void ChampionLogWriter::close(){
+    if (this->writer.joinable()){
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->wake.notify_one();
+        this->writer.join();
+    }
+    if (this->file != nullptr) fclose(this->file);
+    this->file = nullptr;
+}
@@ -0,0 +1,85 @@
+#ifndef CHAMPIONLOG_H
+#define CHAMPIONLOG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//Append only history of champions (see NEATAgent.start_champion_log). Laid out as (all little endian):
+//  header: uint32 magic "NECL" | uint32 version (1) | uint32 inputs | uint32 outputs | uint32 hidden_function | uint32 output_function
+//  record: uint32 record_size | uint32 generation | float32 fitness | uint32 connection_count | connection_count * (uint32 from, uint32 to, float32 weight)
+//Connections are pruned and renumbered the same way as extract_champion_data. record_size covers the whole record, so a reader
+//can step from record to record without decoding connections, and a record cut short by a crash is detected and dropped
+namespace champion_log {
+    const uint32_t MAGIC = 0x4C43454E; //"NECL"
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = 6 * sizeof(uint32_t);
+    const size_t RECORD_HEADER_SIZE = 4 * sizeof(uint32_t);
+
+    struct Header {
+        uint32_t inputs;
+        uint32_t outputs;
+        uint32_t hidden_function;
+        uint32_t output_function;
+    };
+
+    struct Connection {
+        uint32_t from;
+        uint32_t to;
+        float weight;
+    };
+    static_assert(sizeof(Connection) == 12, "Connections are stored as three 4 byte fields");
+}
+
+//Read only mapping of a log. Opening only walks the record headers to find where each record starts
+struct ChampionLogFile {
+    champion_log::Header header = {};
+    std::string last_error;
+
+    bool map_file(const std::string &path);
+    void clear();
+    int entry_count() const { return (int)this->offsets.size(); }
+    size_t valid_size() const; //Bytes up to the end of the last whole record
+
+    int entry_generation(int entry) const;
+    float entry_fitness(int entry) const;
+    int entry_connection_count(int entry) const;
+    champion_log::Connection entry_connection(int entry, int index) const;
+
+    ~ChampionLogFile();
+
+private:
+    const uint8_t* base = nullptr;
+    size_t mapped_size = 0;
+    std::vector<size_t> offsets;
+    uint32_t read_u32(size_t offset) const;
+};
+
+//Encodes records on the calling thread and writes them from a background thread, so a new champion never waits on the disk
+struct ChampionLogWriter {
+    std::string last_error;
+
+    //Appends to an existing log with the same header, after dropping a trailing partial record
+    bool open(const std::string &path, const champion_log::Header &header);
+    void append(int generation, float fitness, const std::vector<champion_log::Connection> &connections);
+    void close(); //Writes everything queued first
+
+    ~ChampionLogWriter();
+
+private:
+    FILE* file = nullptr;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::vector<uint8_t>> queued;
+    bool stopping = false;
+
+    void write_loop();
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include "ChampionLogReader.h"
+#include <godot_cpp/classes/project_settings.hpp>
+
+using namespace godot;
+
+void ChampionLogReader::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("open", "path"), &ChampionLogReader::open);
+    ClassDB::bind_method(D_METHOD("close"), &ChampionLogReader::close);
+    ClassDB::bind_method(D_METHOD("get_entry_count"), &ChampionLogReader::get_entry_count);
+    ClassDB::bind_method(D_METHOD("get_entry_generation", "entry"), &ChampionLogReader::get_entry_generation);
+    ClassDB::bind_method(D_METHOD("get_entry_fitness", "entry"), &ChampionLogReader::get_entry_fitness);
+    ClassDB::bind_method(D_METHOD("get_entry_data", "entry"), &ChampionLogReader::get_entry_data);
+    ClassDB::bind_method(D_METHOD("load_entry", "entry"), &ChampionLogReader::load_entry);
+}
+
+bool ChampionLogReader::open(String path){ //NOTE: Sees the entries written so far, open again to pick up newer ones. A partly written last entry is skipped
+    std::string path_str = ProjectSettings::get_singleton()->globalize_path(path).utf8().get_data();
+    bool mapped = this->log.map_file(path_str);
+    ERR_FAIL_COND_V_MSG(!mapped, false, ("ChampionLogReader Open Error: " + this->log.last_error).c_str());
+    return true;
+}
+
+void ChampionLogReader::close(){
+    this->log.clear();
+}
+
+int ChampionLogReader::get_entry_count(){
+    return this->log.entry_count();
+}
+
+int ChampionLogReader::get_entry_generation(int entry){
+    ERR_FAIL_COND_V_MSG(entry < 0 || entry >= this->log.entry_count(), -1, "ChampionLogReader Entry Error: Entry must be in range 0 to entry_count-1");
+    return this->log.entry_generation(entry);
+}
+
+float ChampionLogReader::get_entry_fitness(int entry){
+    ERR_FAIL_COND_V_MSG(entry < 0 || entry >= this->log.entry_count(), -1.0, "ChampionLogReader Entry Error: Entry must be in range 0 to entry_count-1");
+    return this->log.entry_fitness(entry);
+}
+
+Array ChampionLogReader::get_entry_data(int entry){ //NOTE: Same layout as NEATAgent.extract_champion_data, so it also works with import_template
+    ERR_FAIL_COND_V_MSG(entry < 0 || entry >= this->log.entry_count(), Array(), "ChampionLogReader Entry Error: Entry must be in range 0 to entry_count-1");
+
+    Array network_data;
+    network_data.append((int)this->log.header.inputs);
+    network_data.append((int)this->log.header.outputs);
+    network_data.append((int)this->log.header.hidden_function);
+    network_data.append((int)this->log.header.output_function);
+
+    int connection_count = this->log.entry_connection_count(entry);
+    for (int i = 0; i < connection_count; i++){
+        champion_log::Connection connection = this->log.entry_connection(entry, i);
+        Array connection_array;
+        connection_array.append((int)connection.from);
+        connection_array.append((int)connection.to);
+        connection_array.append(connection.weight);
+        network_data.append(connection_array);
+    }
+    return network_data;
+}
+
+Ref<NetworkAgent> ChampionLogReader::load_entry(int entry){
+    ERR_FAIL_COND_V_MSG(entry < 0 || entry >= this->log.entry_count(), Ref<NetworkAgent>(), "ChampionLogReader Entry Error: Entry must be in range 0 to entry_count-1");
+
+    //Straight from the mapped record into the shared model cache, no Array round trip
+    int connection_count = this->log.entry_connection_count(entry);
+    std::vector<champion_log::Connection> connections(connection_count);
+    for (int i = 0; i < connection_count; i++) connections[i] = this->log.entry_connection(entry, i);
+
+    Ref<NetworkAgent> agent;
+    agent.instantiate();
+    agent->set_model(network_model::acquire(this->log.header, connections));
+    return agent;
+}
@@ -0,0 +1,29 @@
+#ifndef CHAMPIONLOGREADER_H
+#define CHAMPIONLOGREADER_H
+
+#include "ChampionLog.h"
+#include "NetworkAgent.h"
+#include <godot_cpp/classes/ref_counted.hpp>
+
+namespace godot {
+
+    //Reads a log written by NEATAgent.start_champion_log. Entries are decoded only when asked for, so opening a long history is cheap
+    class ChampionLogReader : public RefCounted {
+        GDCLASS(ChampionLogReader, RefCounted);
+    protected:
+        static void _bind_methods();
+    private:
+        ChampionLogFile log;
+
+    public:
+        bool open(String path);
+        void close();
+        int get_entry_count();
+        int get_entry_generation(int entry);
+        float get_entry_fitness(int entry);
+        Array get_entry_data(int entry);
+        Ref<NetworkAgent> load_entry(int entry);
+    };
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include "CompactGenome.h"
+#include "MemoryUsage.h"
+
+std::shared_ptr<const PackedGenome> PackedGenome::pack(const std::vector<std::vector<float>> &connections){
+    std::shared_ptr<PackedGenome> packed = std::make_shared<PackedGenome>();
+    packed->genes.reserve(connections.size() * GENE_WIDTH);
+    for (const std::vector<float> &connection : connections){
+        packed->genes.insert(packed->genes.end(), connection.begin(), connection.begin() + GENE_WIDTH);
+    }
+    return packed;
+}
+
+size_t PackedGenome::get_memory_usage() const {
+    return sizeof(PackedGenome) + memory_usage::HEAP_BLOCK_OVERHEAD + memory_usage::vector_bytes(this->genes);
+}
+
+bool GenomeDelta::encode(const PackedGenome &base, const std::vector<std::vector<float>> &connections){
+    clear();
+    int base_size = base.size();
+    if (connections.size() < base_size) return false;
+
+    //Delta entries cost 8 bytes, appended genes 20, give up once that reaches half of a new base
+    size_t budget = connections.size() * GENE_WIDTH * sizeof(float) / 2;
+    size_t used = (connections.size() - base_size) * GENE_WIDTH * sizeof(float);
+    if (used >= budget) return false;
+
+    for (int i = 0; i < base_size; i++){
+        const float* old_gene = base.gene(i);
+        const std::vector<float> &connection = connections[i];
+        if (connection[0] != old_gene[0] || connection[1] != old_gene[1] || connection[4] != old_gene[4]) return false;
+
+        if (connection[2] != old_gene[2]){
+            this->weights.push_back({i, connection[2]});
+            used += sizeof(std::pair<int, float>);
+        }
+        if (connection[3] != old_gene[3]){
+            this->enabled.push_back({i, connection[3]});
+            used += sizeof(std::pair<int, float>);
+        }
+        if (used >= budget) return false;
+    }
+
+    for (int i = base_size; i < connections.size(); i++){
+        this->added.insert(this->added.end(), connections[i].begin(), connections[i].begin() + GENE_WIDTH);
+    }
+    this->weights.shrink_to_fit();
+    this->enabled.shrink_to_fit();
+    return true;
+}
+
+void GenomeDelta::apply(const PackedGenome &base, std::vector<std::vector<float>> &connections) const {
+    connections.clear();
+    connections.reserve(gene_count(base));
+    for (int i = 0; i < base.size(); i++) connections.emplace_back(base.gene(i), base.gene(i) + GENE_WIDTH);
+    for (const std::pair<int, float> &change : this->weights) connections[change.first][2] = change.second;
+    for (const std::pair<int, float> &change : this->enabled) connections[change.first][3] = change.second;
+    for (size_t i = 0; i < this->added.size(); i += GENE_WIDTH){
+        connections.emplace_back(this->added.begin() + i, this->added.begin() + i + GENE_WIDTH);
+    }
+}
+
+int GenomeDelta::gene_count(const PackedGenome &base) const {
+    return base.size() + this->added.size() / GENE_WIDTH;
+}
+
+void GenomeDelta::clear(){
+    this->weights.clear();
+    this->enabled.clear();
+    this->added.clear();
+}
+
+size_t GenomeDelta::get_memory_usage() const {
+    return memory_usage::vector_bytes(this->weights) + memory_usage::vector_bytes(this->enabled) + memory_usage::vector_bytes(this->added);
+}
@@ -0,0 +1,39 @@
+#ifndef COMPACTGENOME_H
+#define COMPACTGENOME_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <utility>
+
+//Compact genomes (see NEATAgent::set_compact_genomes). Genes use the same layout as Network::connection_data,
+//from, to, weight, enabled, innovation, but are stored flat instead of one heap block per gene
+const int GENE_WIDTH = 5;
+
+//Immutable, shared between every network whose genome is written as a delta against it
+struct PackedGenome {
+    std::vector<float> genes;
+
+    int size() const { return this->genes.size() / GENE_WIDTH; }
+    const float* gene(int index) const { return this->genes.data() + (size_t)index * GENE_WIDTH; }
+    size_t get_memory_usage() const;
+
+    static std::shared_ptr<const PackedGenome> pack(const std::vector<std::vector<float>> &connections);
+};
+
+//Sparse difference from a base. Mutation only rewrites weights and enabled flags in place and appends genes, and crossover keeps
+//the fitter parent's gene order, so a child lines up with its parent's base gene for gene
+struct GenomeDelta {
+    std::vector<std::pair<int, float>> weights; //Gene index and its weight
+    std::vector<std::pair<int, float>> enabled; //Gene index and its enabled flag
+    std::vector<float> added; //Genes past the end of the base, GENE_WIDTH floats each
+
+    //Fails if connections dont line up with base, or the delta would take at least half the memory of a base of its own
+    bool encode(const PackedGenome &base, const std::vector<std::vector<float>> &connections);
+    void apply(const PackedGenome &base, std::vector<std::vector<float>> &connections) const;
+    int gene_count(const PackedGenome &base) const;
+    void clear();
+    size_t get_memory_usage() const;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef COMPILEDNETWORK_H
+#define COMPILEDNETWORK_H
+
+#include <cstdint>
+#include <cmath>
+
+//Evaluation of a compiled inference path (see Network::compile_live_network) straight from flat arrays, used by worker processes
+//and shared memory readers. Plain C++ so external programs can include it without godot-cpp
+namespace compiled_network {
+    //Node kinds
+    const int32_t KIND_INPUT = 0;
+    const int32_t KIND_HIDDEN = 1;
+    const int32_t KIND_OUTPUT = 2;
+
+    //Function numbering is the same as extract_champion_data: 0 relu, 1 linear, 2 sigmoid, 3 tanh
+    inline float activation(float x, int32_t type){
+        if (type == 0) return (x > 0) ? x : 0.01f * x;
+        if (type == 1) return x;
+        if (type == 2) return 1.0 / (1.0 + exp(-x));
+        if (type == 3) return tanh(x);
+        return 0.0;
+    }
+
+    //Nodes are in evaluation order. Edges of node i are edge_start[i] to edge_start[i + 1], edge_to holds node indices.
+    //inputs must include the trailing bias input of 1.0, scratch needs node_count floats
+    inline void evaluate(int32_t node_count, const int32_t* kind, const int32_t* io_index, const int32_t* edge_start, const int32_t* edge_to, const float* edge_weight,
+                         int32_t output_count, int32_t hidden_function, int32_t output_function, const float* inputs, float* outputs, float* scratch){
+        for (int32_t i = 0; i < node_count; i++) scratch[i] = 0.0f;
+        for (int32_t i = 0; i < output_count; i++) outputs[i] = 0.0f;
+
+        for (int32_t i = 0; i < node_count; i++){
+            float value = scratch[i];
+            if (kind[i] == KIND_INPUT){
+                value = inputs[io_index[i]];
+            }
+            else if (kind[i] == KIND_OUTPUT){
+                outputs[io_index[i]] = activation(value, output_function);
+                continue;
+            }
+            else{
+                value = activation(value, hidden_function);
+            }
+            for (int32_t e = edge_start[i]; e < edge_start[i + 1]; e++){
+                scratch[edge_to[e]] += value * edge_weight[e];
+            }
+        }
+    }
+
+    //activation over n values, the function is chosen once rather than per value
+    inline void activation_batch(float* values, int32_t n, int32_t type){
+        if (type == 0) for (int32_t i = 0; i < n; i++) values[i] = (values[i] > 0) ? values[i] : 0.01f * values[i];
+        else if (type == 1) return;
+        else if (type == 2) for (int32_t i = 0; i < n; i++) values[i] = 1.0 / (1.0 + exp(-values[i]));
+        else if (type == 3) for (int32_t i = 0; i < n; i++) values[i] = tanh(values[i]);
+        else for (int32_t i = 0; i < n; i++) values[i] = 0.0f;
+    }
+
+    //Same as evaluate for batch queries at once. inputs, outputs and scratch hold batch values per input, output and node
+    //(inputs[i * batch + b]), so every edge is one multiply-add over the batch that the compiler can vectorize.
+    //scratch needs node_count * batch floats
+    inline void evaluate_batch(int32_t node_count, const int32_t* kind, const int32_t* io_index, const int32_t* edge_start, const int32_t* edge_to, const float* edge_weight,
+                               int32_t output_count, int32_t hidden_function, int32_t output_function, int32_t batch, const float* inputs, float* outputs, float* scratch){
+        for (int32_t i = 0; i < node_count * batch; i++) scratch[i] = 0.0f;
+        for (int32_t i = 0; i < output_count * batch; i++) outputs[i] = 0.0f;
+
+        for (int32_t i = 0; i < node_count; i++){
+            float* values = scratch + (int64_t)i * batch;
+            if (kind[i] == KIND_INPUT){
+                const float* source = inputs + (int64_t)io_index[i] * batch;
+                for (int32_t b = 0; b < batch; b++) values[b] = source[b];
+            }
+            else if (kind[i] == KIND_OUTPUT){
+                float* target = outputs + (int64_t)io_index[i] * batch;
+                for (int32_t b = 0; b < batch; b++) target[b] = values[b];
+                activation_batch(target, batch, output_function);
+                continue;
+            }
+            else{
+                activation_batch(values, batch, hidden_function);
+            }
+            for (int32_t e = edge_start[i]; e < edge_start[i + 1]; e++){
+                float* target = scratch + (int64_t)edge_to[e] * batch;
+                float weight = edge_weight[e];
+                for (int32_t b = 0; b < batch; b++) target[b] += values[b] * weight;
+            }
+        }
+    }
+
+    //Same as evaluate for lanes networks that share one schedule and differ only in weights, all given the same inputs.
+    //lane_weights holds every lane's weight for an edge together (lane_weights[e * lanes + l]), outputs and scratch hold lanes
+    //values per output and node. Each lane does exactly the operations evaluate would, so results match it
+    inline void evaluate_lanes(int32_t node_count, const int32_t* kind, const int32_t* io_index, const int32_t* edge_start, const int32_t* edge_to, const float* lane_weights,
+                               int32_t output_count, int32_t hidden_function, int32_t output_function, int32_t lanes, const float* inputs, float* outputs, float* scratch){
+        for (int32_t i = 0; i < node_count * lanes; i++) scratch[i] = 0.0f;
+        for (int32_t i = 0; i < output_count * lanes; i++) outputs[i] = 0.0f;
+
+        for (int32_t i = 0; i < node_count; i++){
+            float* values = scratch + (int64_t)i * lanes;
+            if (kind[i] == KIND_INPUT){
+                float input = inputs[io_index[i]];
+                for (int32_t l = 0; l < lanes; l++) values[l] = input;
+            }
+            else if (kind[i] == KIND_OUTPUT){
+                float* target = outputs + (int64_t)io_index[i] * lanes;
+                for (int32_t l = 0; l < lanes; l++) target[l] = values[l];
+                activation_batch(target, lanes, output_function);
+                continue;
+            }
+            else{
+                activation_batch(values, lanes, hidden_function);
+            }
+            for (int32_t e = edge_start[i]; e < edge_start[i + 1]; e++){
+                float* target = scratch + (int64_t)edge_to[e] * lanes;
+                const float* weights = lane_weights + (int64_t)e * lanes;
+                for (int32_t l = 0; l < lanes; l++) target[l] += values[l] * weights[l];
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,156 @@
+#include "Dataset.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+Dataset::~Dataset(){
+    clear();
+}
+
+bool Dataset::is_loaded() const {
+    return this->rows > 0;
+}
+
+bool Dataset::set_arrays(const std::vector<float> &inputs, const std::vector<float> &targets, int input_size, int target_size){
+    clear();
+    if (input_size < 1 || target_size < 1 || inputs.size() % input_size != 0 || targets.size() % target_size != 0){
+        this->last_error = "Input and target arrays must hold whole rows";
+        return false;
+    }
+    if (inputs.size() / input_size != targets.size() / target_size || inputs.empty()){
+        this->last_error = "Input and target arrays must hold the same number of rows, and at least one";
+        return false;
+    }
+
+    this->owned_inputs = inputs;
+    this->owned_targets = targets;
+    this->rows = inputs.size() / input_size;
+    this->input_size = input_size;
+    this->target_size = target_size;
+    this->input_base = this->owned_inputs.data();
+    this->target_base = this->owned_targets.data();
+    this->row_stride = input_size;
+    this->target_stride = target_size;
+    return true;
+}
+
+#ifdef _WIN32
+
+bool Dataset::map_file(const std::string &path){
+    clear();
+    this->last_error = "Memory mapped datasets are not supported on this platform";
+    return false;
+}
+
+void Dataset::clear(){
+    this->owned_inputs.clear();
+    this->owned_targets.clear();
+    this->input_base = nullptr;
+    this->target_base = nullptr;
+    this->rows = 0;
+}
+
+#else
+
+bool Dataset::map_file(const std::string &path){
+    clear();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        this->last_error = "Could not open dataset file " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < dataset_file::HEADER_SIZE){
+        ::close(fd);
+        this->last_error = "Dataset file is too small to hold a header";
+        return false;
+    }
+
+    //The mapping stays valid after the descriptor is closed
+    size_t size = info.st_size;
+    void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED){
+        this->last_error = "Could not map dataset file " + path;
+        return false;
+    }
+
+    uint32_t header[5];
+    std::memcpy(header, base, sizeof(header));
+    size_t stride = (size_t)header[3] + header[4];
+    std::string error;
+    if (header[0] != dataset_file::MAGIC || header[1] != dataset_file::VERSION) error = "Dataset file has the wrong magic or version";
+    else if (header[2] == 0 || header[3] == 0 || header[4] == 0) error = "Dataset file must have at least one row, input and target";
+    else if (header[2] > INT_MAX || header[3] > INT_MAX || header[4] > INT_MAX) error = "Dataset file sizes are too large";
+    //Rows that fit in the file, divided rather than multiplied so a corrupt header cant overflow past the check
+    else if (header[2] > (size - dataset_file::HEADER_SIZE) / (stride * sizeof(float))) error = "Dataset file is shorter than its header says";
+    if (!error.empty()){
+        munmap(base, size);
+        this->last_error = error;
+        return false;
+    }
+
+    this->mapped = base;
+    this->mapped_size = size;
+    this->rows = header[2];
+    this->input_size = header[3];
+    this->target_size = header[4];
+    this->input_base = (const float*)((const uint8_t*)base + dataset_file::HEADER_SIZE);
+    this->target_base = this->input_base + this->input_size;
+    this->row_stride = stride;
+    this->target_stride = stride;
+    return true;
+}
+
+void Dataset::clear(){
+    if (this->mapped != nullptr) munmap(this->mapped, this->mapped_size);
+    this->mapped = nullptr;
+    this->mapped_size = 0;
+    this->owned_inputs.clear();
+    this->owned_targets.clear();
+    this->input_base = nullptr;
+    this->target_base = nullptr;
+    this->rows = 0;
+}
+
+#endif
+
+float Dataset::row_loss(Loss loss, const float* outputs, const float* targets, int count){
+    const float epsilon = 1e-7f;
+
+    if (loss == LOSS_MSE){
+        float sum = 0.0f;
+        for (int i = 0; i < count; i++) sum += (outputs[i] - targets[i]) * (outputs[i] - targets[i]);
+        return sum / count;
+    }
+
+    if (loss == LOSS_CROSS_ENTROPY){
+        //One output is a binary probability, several are softmaxed into a distribution
+        if (count == 1){
+            float p = std::min(std::max(outputs[0], epsilon), 1.0f - epsilon);
+            return -(targets[0] * std::log(p) + (1.0f - targets[0]) * std::log(1.0f - p));
+        }
+        float largest = *std::max_element(outputs, outputs + count);
+        float total = 0.0f;
+        for (int i = 0; i < count; i++) total += std::exp(outputs[i] - largest);
+        float log_total = std::log(total);
+        float sum = 0.0f;
+        for (int i = 0; i < count; i++) sum -= targets[i] * (outputs[i] - largest - log_total);
+        return sum;
+    }
+
+    //Accuracy, thresholded for one output and argmax for several
+    if (count == 1) return ((outputs[0] > 0.5f) == (targets[0] > 0.5f)) ? 1.0f : 0.0f;
+    int guessed = std::max_element(outputs, outputs + count) - outputs;
+    int expected = std::max_element(targets, targets + count) - targets;
+    return guessed == expected ? 1.0f : 0.0f;
+}
@@ -0,0 +1,52 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//Supervised dataset for NEATAgent.evaluate_dataset. Rows either live in owned arrays or are read straight from a read only
+//mapping of a binary file laid out as (all little endian, FileAccess.store_32 / store_float write this from GDScript):
+//  uint32 magic "NEAD" | uint32 version (1) | uint32 rows | uint32 input_size | uint32 target_size | rows * (input_size + target_size) float32
+//with every row's inputs followed by its targets. Inputs dont include the bias
+namespace dataset_file {
+    const uint32_t MAGIC = 0x4441454E; //"NEAD"
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = 5 * sizeof(uint32_t);
+}
+
+struct Dataset {
+    enum Loss { LOSS_MSE, LOSS_CROSS_ENTROPY, LOSS_ACCURACY };
+
+    int rows = 0;
+    int input_size = 0;
+    int target_size = 0;
+    std::string last_error;
+
+    bool set_arrays(const std::vector<float> &inputs, const std::vector<float> &targets, int input_size, int target_size);
+    bool map_file(const std::string &path);
+    void clear();
+    bool is_loaded() const;
+
+    const float* row_inputs(int row) const { return this->input_base + (size_t)row * this->row_stride; }
+    const float* row_targets(int row) const { return this->target_base + (size_t)row * this->target_stride; }
+
+    //Loss of one row, for accuracy this is 1.0 for a correct row and 0.0 otherwise
+    static float row_loss(Loss loss, const float* outputs, const float* targets, int count);
+
+    ~Dataset();
+
+private:
+    std::vector<float> owned_inputs;
+    std::vector<float> owned_targets;
+    const float* input_base = nullptr;
+    const float* target_base = nullptr;
+    size_t row_stride = 0;
+    size_t target_stride = 0;
+
+    void* mapped = nullptr;
+    size_t mapped_size = 0;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "EvaluationRace.h"
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+void EvaluationRace::start(int network_count){
+    this->entries.assign(network_count, Entry());
+    for (Entry &entry : this->entries) entry.owed = this->min_episodes;
+    this->episodes_run = 0;
+    this->active = network_count > 0;
+}
+
+void EvaluationRace::add_episode(int index, float fitness){
+    Entry &entry = this->entries[index];
+    entry.episodes++;
+    double delta = fitness - entry.mean;
+    entry.mean += delta / entry.episodes;
+    entry.m2 += delta * (fitness - entry.mean);
+    if (entry.owed > 0) entry.owed--;
+    this->episodes_run++;
+}
+
+void EvaluationRace::next_batch(std::vector<int> &out){
+    out.clear();
+    if (!this->active) return;
+
+    auto collect = [this, &out]() {
+        for (int i = 0; i < this->entries.size(); i++){
+            for (int e = 0; e < this->entries[i].owed; e++) out.push_back(i);
+        }
+    };
+    collect();
+    if (!out.empty()) return;
+
+    if (!close_round()){
+        this->active = false;
+        return;
+    }
+    collect();
+}
+
+double EvaluationRace::half_width(const Entry &entry) const {
+    if (entry.episodes < 2) return std::numeric_limits<double>::infinity();
+    double variance = entry.m2 / (entry.episodes - 1);
+    return this->confidence * std::sqrt(variance / entry.episodes);
+}
+
+bool EvaluationRace::close_round(){
+    return (this->mode == MODE_HALVING) ? close_halving_round() : close_racing_round();
+}
+
+bool EvaluationRace::close_halving_round(){
+    std::vector<int> &racing = this->order_scratch;
+    racing.clear();
+    for (int i = 0; i < this->entries.size(); i++){
+        if (this->entries[i].state == STATE_RACING) racing.push_back(i);
+    }
+    if (racing.size() <= 1) return false;
+
+    //Best keep_fraction go on, ties broken by index so the order never depends on the sort
+    int keep = std::max(1, (int)std::ceil(racing.size() * this->keep_fraction));
+    std::sort(racing.begin(), racing.end(), [this](int a, int b) {
+        if (this->entries[a].mean != this->entries[b].mean) return this->entries[a].mean > this->entries[b].mean;
+        return a < b;
+    });
+    for (int r = keep; r < racing.size(); r++) this->entries[racing[r]].state = STATE_DROPPED;
+    if (keep == 1){
+        this->entries[racing[0]].state = STATE_SETTLED;
+        return false;
+    }
+
+    //Survivors get episodes up to episodes / keep_fraction, so every round costs about the same
+    bool owed = false;
+    for (int r = 0; r < keep; r++){
+        Entry &entry = this->entries[racing[r]];
+        int target = std::min(this->max_episodes, (int)std::ceil(entry.episodes / this->keep_fraction));
+        entry.owed = std::max(0, target - entry.episodes);
+        if (entry.owed == 0) entry.state = STATE_SETTLED;
+        owed = owed || entry.owed > 0;
+    }
+    return owed;
+}
+
+double EvaluationRace::kth_largest(std::vector<double> &values, int k){
+    if (k > values.size()) return -std::numeric_limits<double>::infinity();
+    std::nth_element(values.begin(), values.begin() + (k - 1), values.end(), std::greater<double>());
+    return values[k - 1];
+}
+
+bool EvaluationRace::close_racing_round(){
+    //The race only needs to find which networks make the best keep_fraction of the whole population
+    int top = std::max(1, (int)std::ceil(this->entries.size() * this->keep_fraction));
+
+    //A racing network is dropped when its upper bound is below the top-th best lower bound, and settled when its
+    //lower bound is above the (top+1)-th best upper bound
+    std::vector<double> &bounds = this->bound_scratch;
+    bounds.clear();
+    for (const Entry &entry : this->entries){
+        if (entry.state != STATE_DROPPED) bounds.push_back(entry.mean - half_width(entry));
+    }
+    int contenders = bounds.size();
+    double drop_below = kth_largest(bounds, top);
+
+    bounds.clear();
+    for (const Entry &entry : this->entries){
+        if (entry.state != STATE_DROPPED) bounds.push_back(entry.mean + half_width(entry));
+    }
+    double settle_above = kth_largest(bounds, top + 1);
+
+    bool owed = false;
+    for (Entry &entry : this->entries){
+        if (entry.state != STATE_RACING) continue;
+
+        double width = half_width(entry);
+        if (contenders <= top || entry.episodes >= this->max_episodes || entry.mean - width > settle_above) entry.state = STATE_SETTLED;
+        else if (entry.mean + width < drop_below) entry.state = STATE_DROPPED;
+        else{
+            entry.owed = 1;
+            owed = true;
+        }
+    }
+    return owed;
+}
+
+size_t EvaluationRace::get_memory_usage() const {
+    return sizeof(EvaluationRace) + memory_usage::vector_bytes(this->entries) + memory_usage::vector_bytes(this->order_scratch) + memory_usage::vector_bytes(this->bound_scratch);
+}
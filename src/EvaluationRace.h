@@ -0,0 +1,54 @@
+#ifndef EVALUATIONRACE_H
+#define EVALUATIONRACE_H
+
+#include <vector>
+#include <cstddef>
+
+//Hands out noisy episodes in rounds and stops spending them on networks that are clearly behind (see NEATAgent.start_racing).
+//Halving keeps the best keep_fraction after every round and gives the survivors more episodes. Racing gives one episode a
+//round and drops a network once its confidence interval sits wholly below the best keep_fraction, or stops sampling it once it
+//sits wholly above the rest
+struct EvaluationRace {
+    enum Mode { MODE_HALVING, MODE_RACING };
+
+    Mode mode = MODE_HALVING;
+    int min_episodes = 2;
+    int max_episodes = 10;
+    float keep_fraction = 0.5f;
+    float confidence = 1.96f; //Interval half width in standard errors
+    bool active = false;
+    int episodes_run = 0;
+    int generation = 0; //Entries only describe the population of this generation
+
+    void start(int network_count);
+    void add_episode(int index, float fitness);
+    //Episodes still owed this round, one entry per episode. Starts the next round when the current one is done, empty once the race is over
+    void next_batch(std::vector<int> &out);
+
+    int entry_count() const { return (int)this->entries.size(); }
+    int episodes(int index) const { return this->entries[index].episodes; }
+    float estimate(int index) const { return (float)this->entries[index].mean; }
+    size_t get_memory_usage() const;
+
+private:
+    enum State { STATE_RACING, STATE_SETTLED, STATE_DROPPED }; //Settled networks keep counting in comparisons, dropped ones dont
+
+    struct Entry {
+        int episodes = 0;
+        double mean = 0.0; //Welford running mean and squared deviation sum
+        double m2 = 0.0;
+        int owed = 0;
+        State state = STATE_RACING;
+    };
+    std::vector<Entry> entries;
+    std::vector<int> order_scratch;
+    std::vector<double> bound_scratch;
+
+    double half_width(const Entry &entry) const;
+    bool close_round(); //Returns false when nothing is left to race
+    bool close_halving_round();
+    bool close_racing_round();
+    double kth_largest(std::vector<double> &values, int k);
+};
+
+#endif
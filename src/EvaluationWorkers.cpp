@@ -0,0 +1,288 @@
+#include "EvaluationWorkers.h"
+#include "WorkerProtocol.h"
+#include <deque>
+#include <algorithm>
+#include <cmath>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+EvaluationWorkerPool::~EvaluationWorkerPool(){
+    stop();
+}
+
+bool EvaluationWorkerPool::is_running(){
+    for (Worker &worker : this->workers){
+        if (worker.pid > 0) return true;
+    }
+    return false;
+}
+
+#ifdef _WIN32
+
+bool EvaluationWorkerPool::start(const std::string &path, const std::vector<std::string> &args, int worker_count, int timeout_ms, int pipeline_depth){
+    this->last_error = "Evaluation workers are not supported on this platform";
+    return false;
+}
+
+void EvaluationWorkerPool::stop(){
+    this->workers.clear();
+}
+
+int EvaluationWorkerPool::evaluate(const std::vector<std::vector<uint8_t>> &payloads, std::vector<float> &fitness, float failure_value){
+    fitness.assign(payloads.size(), failure_value);
+    return payloads.size();
+}
+
+bool EvaluationWorkerPool::spawn(Worker &worker){
+    return false;
+}
+
+void EvaluationWorkerPool::kill_worker(Worker &worker){}
+
+#else
+
+bool EvaluationWorkerPool::start(const std::string &path, const std::vector<std::string> &args, int worker_count, int timeout_ms, int pipeline_depth){
+    stop();
+
+    if (access(path.c_str(), X_OK) != 0){
+        this->last_error = "Worker executable not found or not executable: " + path;
+        return false;
+    }
+
+    this->executable_path = path;
+    this->arguments = args;
+    this->timeout_ms = timeout_ms;
+    this->pipeline_depth = pipeline_depth;
+    this->workers.resize(worker_count);
+
+    for (Worker &worker : this->workers){
+        if (!spawn(worker)){
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+void EvaluationWorkerPool::stop(){
+    for (Worker &worker : this->workers){
+        if (worker.pid <= 0) continue;
+
+        //Ask nicely first, then make sure it is gone
+        worker_protocol::MessageHeader shutdown = {worker_protocol::MAGIC, worker_protocol::MESSAGE_SHUTDOWN, 0, 0};
+        send(worker.fd, &shutdown, sizeof(shutdown), MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(worker.fd);
+        worker.fd = -1;
+
+        for (int i = 0; i < 20; i++){
+            if (waitpid(worker.pid, nullptr, WNOHANG) != 0){
+                worker.pid = -1;
+                break;
+            }
+            usleep(5000);
+        }
+        if (worker.pid > 0) kill_worker(worker);
+    }
+    this->workers.clear();
+}
+
+bool EvaluationWorkerPool::spawn(Worker &worker){
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0){
+        this->last_error = "Could not create a socket for a worker";
+        return false;
+    }
+
+    //Host end must not leak into other workers, worker end becomes stdin and stdout
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+    //Build argv before forking, only async signal safe calls are allowed in the child
+    std::vector<char*> argv;
+    argv.push_back((char*)this->executable_path.c_str());
+    for (const std::string &arg : this->arguments) argv.push_back((char*)arg.c_str());
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0){
+        close(fds[0]);
+        close(fds[1]);
+        this->last_error = "Could not fork a worker process";
+        return false;
+    }
+    if (pid == 0){
+        dup2(fds[1], 0);
+        dup2(fds[1], 1);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    worker.pid = pid;
+    worker.fd = fds[0];
+    worker.send_buffer.clear();
+    worker.send_offset = 0;
+    worker.receive_buffer.clear();
+    worker.in_flight.clear();
+    worker.last_progress = std::chrono::steady_clock::now();
+    return true;
+}
+
+void EvaluationWorkerPool::kill_worker(Worker &worker){
+    if (worker.fd >= 0) close(worker.fd);
+    if (worker.pid > 0){
+        kill(worker.pid, SIGKILL);
+        waitpid(worker.pid, nullptr, 0);
+    }
+    worker.fd = -1;
+    worker.pid = -1;
+}
+
+int EvaluationWorkerPool::evaluate(const std::vector<std::vector<uint8_t>> &payloads, std::vector<float> &fitness, float failure_value){
+    int job_count = payloads.size();
+    fitness.assign(job_count, failure_value);
+
+    std::deque<int> pending;
+    for (int i = 0; i < job_count; i++) pending.push_back(i);
+    std::vector<int> attempts(job_count, 0);
+    std::vector<bool> done(job_count, false);
+    int remaining = job_count;
+    int failed = 0;
+
+    auto finish = [&](int job, float value, bool ok) {
+        if (done[job]) return;
+        done[job] = true;
+        remaining--;
+        if (ok) fitness[job] = value;
+        else failed++;
+    };
+
+    //Kill a misbehaving worker, put its jobs back in the queue and start a replacement
+    auto fail_worker = [&](Worker &worker) {
+        kill_worker(worker);
+        for (int job : worker.in_flight){
+            if (done[job]) continue;
+            if (++attempts[job] > this->max_retries) finish(job, failure_value, false);
+            else pending.push_front(job);
+        }
+        worker.in_flight.clear();
+        spawn(worker);
+    };
+
+    while (remaining > 0){
+        //Keep every worker's pipeline full
+        bool any_alive = false;
+        for (Worker &worker : this->workers){
+            if (worker.pid <= 0) continue;
+            any_alive = true;
+
+            while (worker.in_flight.size() < this->pipeline_depth && !pending.empty()){
+                int job = pending.front();
+                pending.pop_front();
+                if (done[job]) continue;
+
+                if (worker.in_flight.empty()) worker.last_progress = std::chrono::steady_clock::now();
+                worker_protocol::MessageHeader header = {worker_protocol::MAGIC, worker_protocol::MESSAGE_EVALUATE, (uint32_t)job, (uint32_t)payloads[job].size()};
+                worker_protocol::append_raw(worker.send_buffer, &header, sizeof(header));
+                worker.send_buffer.insert(worker.send_buffer.end(), payloads[job].begin(), payloads[job].end());
+                worker.in_flight.push_back(job);
+            }
+        }
+
+        //Nobody left to do the work
+        if (!any_alive){
+            for (int job : pending) finish(job, failure_value, false);
+            this->last_error = "Every evaluation worker died and could not be restarted";
+            break;
+        }
+
+        std::vector<pollfd> poll_fds;
+        std::vector<Worker*> polled;
+        for (Worker &worker : this->workers){
+            if (worker.pid <= 0) continue;
+            short events = POLLIN;
+            if (worker.send_offset < worker.send_buffer.size()) events |= POLLOUT;
+            poll_fds.push_back({worker.fd, events, 0});
+            polled.push_back(&worker);
+        }
+        poll(poll_fds.data(), poll_fds.size(), 50);
+
+        for (int i = 0; i < poll_fds.size(); i++){
+            Worker &worker = *polled[i];
+            short revents = poll_fds[i].revents;
+            bool broken = false;
+
+            //Send as much as the socket takes
+            if (revents & POLLOUT){
+                ssize_t sent = send(worker.fd, worker.send_buffer.data() + worker.send_offset, worker.send_buffer.size() - worker.send_offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (sent > 0){
+                    worker.send_offset += sent;
+                    if (worker.send_offset == worker.send_buffer.size()){
+                        worker.send_buffer.clear();
+                        worker.send_offset = 0;
+                    }
+                }
+                else if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR){
+                    broken = true;
+                }
+            }
+
+            //Read whatever results arrived
+            if (!broken && (revents & (POLLIN | POLLHUP | POLLERR))){
+                uint8_t chunk[4096];
+                ssize_t received = recv(worker.fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+                if (received > 0){
+                    worker.receive_buffer.insert(worker.receive_buffer.end(), chunk, chunk + received);
+                }
+                else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)){
+                    broken = true;
+                }
+            }
+
+            size_t consumed = 0;
+            while (worker.receive_buffer.size() - consumed >= sizeof(worker_protocol::ResultMessage)){
+                worker_protocol::ResultMessage result;
+                memcpy(&result, worker.receive_buffer.data() + consumed, sizeof(result));
+                consumed += sizeof(result);
+
+                auto found = std::find(worker.in_flight.begin(), worker.in_flight.end(), (int)result.job_id);
+                if (found == worker.in_flight.end()) continue; //Stale answer for a job already retried elsewhere
+                worker.in_flight.erase(found);
+                worker.last_progress = std::chrono::steady_clock::now();
+                finish(result.job_id, result.fitness, std::isfinite(result.fitness));
+            }
+            worker.receive_buffer.erase(worker.receive_buffer.begin(), worker.receive_buffer.begin() + consumed);
+
+            //Timed out on its oldest job
+            if (!broken && !worker.in_flight.empty()){
+                auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - worker.last_progress).count();
+                if (waited > this->timeout_ms) broken = true;
+            }
+
+            if (broken) fail_worker(worker);
+        }
+    }
+
+    return failed;
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef EVALUATIONWORKERS_H
+#define EVALUATIONWORKERS_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+//Pool of local worker processes that evaluate encoded networks (see WorkerProtocol.h). Every worker talks over one Unix
+//domain socket mapped to its stdin and stdout. Up to pipeline_depth jobs are queued per worker so it never waits on the host,
+//and a worker that crashes, closes its socket or goes timeout_ms without answering is killed, respawned and its jobs retried.
+//Only available on POSIX platforms
+struct EvaluationWorkerPool {
+    struct Worker {
+        int pid = -1;
+        int fd = -1;
+        std::vector<uint8_t> send_buffer;
+        size_t send_offset = 0;
+        std::vector<uint8_t> receive_buffer;
+        std::vector<int> in_flight; //Job ids sent but not answered yet
+        std::chrono::steady_clock::time_point last_progress;
+    };
+
+    std::string executable_path;
+    std::vector<std::string> arguments;
+    std::vector<Worker> workers;
+    int timeout_ms = 10000;
+    int pipeline_depth = 4;
+    int max_retries = 2;
+    std::string last_error;
+
+    bool start(const std::string &path, const std::vector<std::string> &args, int worker_count, int timeout_ms, int pipeline_depth);
+    void stop();
+    bool is_running();
+
+    //Fills fitness[i] for every payload. Jobs that fail on every retry get failure_value. Returns how many failed
+    int evaluate(const std::vector<std::vector<uint8_t>> &payloads, std::vector<float> &fitness, float failure_value);
+
+    ~EvaluationWorkerPool();
+
+private:
+    bool spawn(Worker &worker);
+    void kill_worker(Worker &worker);
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "InnovationRegistry.h"
+#include "MemoryUsage.h"
+
+int InnovationRegistry::get_innovation(int from_id, int to_id){
+    std::lock_guard<std::mutex> guard(this->lock);
+    std::pair<int, int> id_pair = {from_id, to_id};
+
+    //Didnt find so add the table connection
+    auto found = this->innovation_table.find(id_pair);
+    if (found == this->innovation_table.end()){
+        int innov_num = this->innovation_counter++;
+        this->innovation_table[id_pair] = innov_num;
+        return innov_num;
+    }
+    //Found so take that table slots innov number
+    return found->second;
+}
+
+int InnovationRegistry::new_neuron_id(){
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->neuron_counter++;
+}
+
+void InnovationRegistry::clear(){
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->innovation_table.clear();
+    this->innovation_counter = 0;
+    this->neuron_counter = 0;
+}
+
+size_t InnovationRegistry::get_memory_usage(){
+    std::lock_guard<std::mutex> guard(this->lock);
+    return memory_usage::map_bytes(this->innovation_table);
+}
+
+void InnovationRegistry::compact(const std::set<std::pair<int, int>> &in_use){
+    //Forget innovations no living genome carries. Numbers already handed out never change, a forgotten pair that shows up again just gets a new number
+    std::lock_guard<std::mutex> guard(this->lock);
+    auto it = this->innovation_table.begin();
+    while (it != this->innovation_table.end()) {
+        if (in_use.count(it->first) == 0) it = this->innovation_table.erase(it);
+        else ++it;
+    }
+}
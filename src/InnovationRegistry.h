@@ -0,0 +1,22 @@
+#ifndef INNOVATIONREGISTRY_H
+#define INNOVATIONREGISTRY_H
+
+#include <map>
+#include <set>
+#include <mutex>
+
+//Historical markings shared by every network of a run. Islands evolving on separate threads share one registry, so every call locks
+struct InnovationRegistry {
+    std::mutex lock;
+    std::map<std::pair<int, int>, int> innovation_table;
+    int innovation_counter = 0;
+    int neuron_counter = 0;
+
+    int get_innovation(int from_id, int to_id);
+    int new_neuron_id();
+    void clear();
+    size_t get_memory_usage();
+    void compact(const std::set<std::pair<int, int>> &in_use);
+};
+
+#endif
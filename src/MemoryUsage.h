@@ -0,0 +1,41 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstddef>
+
+//Byte estimates for the containers NEAT uses. Heap blocks are charged a typical malloc header and map nodes the
+//red-black tree links, so results track what the allocator really hands out rather than just sizeof
+namespace memory_usage {
+    const size_t HEAP_BLOCK_OVERHEAD = 16;
+    const size_t MAP_NODE_OVERHEAD = 32;
+
+    template <typename T>
+    size_t vector_bytes(const std::vector<T>& vec){
+        if (vec.capacity() == 0) return 0;
+        return vec.capacity() * sizeof(T) + HEAP_BLOCK_OVERHEAD;
+    }
+
+    template <typename T>
+    size_t nested_vector_bytes(const std::vector<std::vector<T>>& vec){
+        size_t bytes = vector_bytes(vec);
+        for (const std::vector<T>& inner : vec) bytes += vector_bytes(inner);
+        return bytes;
+    }
+
+    template <typename K, typename V>
+    size_t map_bytes(const std::map<K, V>& map){
+        return map.size() * (sizeof(std::pair<const K, V>) + MAP_NODE_OVERHEAD + HEAP_BLOCK_OVERHEAD);
+    }
+
+    template <typename K, typename V>
+    size_t unordered_map_bytes(const std::unordered_map<K, V>& map){
+        //Each node carries a next pointer and the cached hash, plus one pointer per bucket
+        size_t node = sizeof(std::pair<const K, V>) + 2 * sizeof(void*) + HEAP_BLOCK_OVERHEAD;
+        return map.size() * node + map.bucket_count() * sizeof(void*);
+    }
+}
+
+#endif
@@ -1,24 +1,138 @@
 #include "NEATAgent.h"
 #include "Network.h"
 #include "Species.h"
+#include "MemoryUsage.h"
+#include "Parallel.h"
+#include "EvaluationWorkers.h"
+#include "SharedPopulation.h"
+#include "BehaviorArchive.h"
+#include "Dataset.h"
+#include "CompiledNetwork.h"
+#include "Trace.h"
+#include "SpeciesIndex.h"
+#include "ChampionLog.h"
+#include "NEATModel.h"
+#include "Substrate.h"
+#include "EvaluationRace.h"
+#include "ReplayLog.h"
+#include <godot_cpp/classes/project_settings.hpp>
+#include <chrono>
+#include <set>
 
 using namespace godot;
 
+//Trace event names for each GenerationPhase, in enum order
+static const char* PHASE_TRACE_NAMES[] = {"idle", "repopulate", "novelty", "speciate", "adjust", "cull", "allocate", "reproduce", "fill", "swap"};
+
 void NEATAgent::_bind_methods() {
     ClassDB::bind_method(D_METHOD("initialize_population", "inputs", "outputs", "population_size", "hidden_activation", "output_activation", "species_count", "initial_enabled_percent"), &NEATAgent::initialize_population, DEFVAL(150), DEFVAL("tanh"), DEFVAL("tanh"), DEFVAL(8), DEFVAL(0.25));
     ClassDB::bind_method(D_METHOD("import_template", "network_data", "population_size", "species_count"), &NEATAgent::import_template, DEFVAL(150), DEFVAL(8));
+    ClassDB::bind_method(D_METHOD("set_seed", "seed"), &NEATAgent::set_seed);
+    ClassDB::bind_method(D_METHOD("get_seed"), &NEATAgent::get_seed);
     ClassDB::bind_method(D_METHOD("set_mutation_rates", "rate_weight_mutate", "rate_connection_mutate", "rate_enable_mutate", "rate_node_mutate"), &NEATAgent::set_mutation_rates, DEFVAL(0.8), DEFVAL(0.1), DEFVAL(0.05), DEFVAL(0.03));
     ClassDB::bind_method(D_METHOD("get_network_guess", "index", "inputs"), &NEATAgent::get_network_guess);
     ClassDB::bind_method(D_METHOD("get_champion_guess", "inputs"), &NEATAgent::get_champion_guess);
     ClassDB::bind_method(D_METHOD("set_network_fitness", "index", "fitness"), &NEATAgent::set_network_fitness);
     ClassDB::bind_method(D_METHOD("next_generation"), &NEATAgent::next_generation);
+    ClassDB::bind_method(D_METHOD("step_generation", "budget_usec"), &NEATAgent::step_generation);
+    ClassDB::bind_method(D_METHOD("is_generation_in_progress"), &NEATAgent::is_generation_in_progress);
     ClassDB::bind_method(D_METHOD("get_champion_fitness"), &NEATAgent::get_champion_fitness);
     ClassDB::bind_method(D_METHOD("get_champion_connection_count"), &NEATAgent::get_champion_connection_count);
     ClassDB::bind_method(D_METHOD("set_stagnation_limit", "limit"), &NEATAgent::set_stagnation_limit);
     ClassDB::bind_method(D_METHOD("set_connection_size_limit", "limit"), &NEATAgent::set_connection_size_limit);
     ClassDB::bind_method(D_METHOD("extract_champion_data"), &NEATAgent::extract_champion_data);
+    ClassDB::bind_method(D_METHOD("extract_champion_model"), &NEATAgent::extract_champion_model);
     ClassDB::bind_method(D_METHOD("force_champion_reset"), &NEATAgent::force_champion_reset);
     ClassDB::bind_method(D_METHOD("has_champion"), &NEATAgent::has_champion);
+    ClassDB::bind_method(D_METHOD("start_evaluation_workers", "executable_path", "worker_count", "timeout_seconds", "batch_size", "arguments"), &NEATAgent::start_evaluation_workers, DEFVAL(4), DEFVAL(10.0), DEFVAL(4), DEFVAL(PackedStringArray()));
+    ClassDB::bind_method(D_METHOD("evaluate_population_with_workers"), &NEATAgent::evaluate_population_with_workers);
+    ClassDB::bind_method(D_METHOD("stop_evaluation_workers"), &NEATAgent::stop_evaluation_workers);
+    ClassDB::bind_method(D_METHOD("publish_population_shared_memory", "name"), &NEATAgent::publish_population_shared_memory);
+    ClassDB::bind_method(D_METHOD("read_shared_fitness"), &NEATAgent::read_shared_fitness);
+    ClassDB::bind_method(D_METHOD("close_population_shared_memory"), &NEATAgent::close_population_shared_memory);
+    ClassDB::bind_method(D_METHOD("set_island_mode", "island_count", "migration_interval", "migration_size", "topology"), &NEATAgent::set_island_mode, DEFVAL(10), DEFVAL(2), DEFVAL("ring"));
+    ClassDB::bind_method(D_METHOD("get_island_count"), &NEATAgent::get_island_count);
+    ClassDB::bind_method(D_METHOD("get_memory_usage"), &NEATAgent::get_memory_usage);
+    ClassDB::bind_method(D_METHOD("set_memory_budget", "bytes"), &NEATAgent::set_memory_budget);
+    ClassDB::bind_method(D_METHOD("enable_novelty_search", "behavior_dimensions", "novelty_weight", "neighbors", "archive_threshold", "max_archive_size"), &NEATAgent::enable_novelty_search, DEFVAL(0.5), DEFVAL(15), DEFVAL(1.0), DEFVAL(50000));
+    ClassDB::bind_method(D_METHOD("disable_novelty_search"), &NEATAgent::disable_novelty_search);
+    ClassDB::bind_method(D_METHOD("set_network_behavior", "index", "behavior"), &NEATAgent::set_network_behavior);
+    ClassDB::bind_method(D_METHOD("get_network_novelty", "index"), &NEATAgent::get_network_novelty);
+    ClassDB::bind_method(D_METHOD("get_novelty_archive_size"), &NEATAgent::get_novelty_archive_size);
+    ClassDB::bind_method(D_METHOD("enable_fitness_cache", "auto_fill", "max_age_generations"), &NEATAgent::enable_fitness_cache, DEFVAL(false), DEFVAL(10));
+    ClassDB::bind_method(D_METHOD("disable_fitness_cache"), &NEATAgent::disable_fitness_cache);
+    ClassDB::bind_method(D_METHOD("get_cached_network_indices"), &NEATAgent::get_cached_network_indices);
+    ClassDB::bind_method(D_METHOD("get_network_genome_hash", "index"), &NEATAgent::get_network_genome_hash);
+    ClassDB::bind_method(D_METHOD("set_dataset", "inputs", "targets"), &NEATAgent::set_dataset);
+    ClassDB::bind_method(D_METHOD("load_dataset_file", "path"), &NEATAgent::load_dataset_file);
+    ClassDB::bind_method(D_METHOD("clear_dataset"), &NEATAgent::clear_dataset);
+    ClassDB::bind_method(D_METHOD("get_dataset_size"), &NEATAgent::get_dataset_size);
+    ClassDB::bind_method(D_METHOD("evaluate_dataset", "loss", "batch_size"), &NEATAgent::evaluate_dataset, DEFVAL("mse"), DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("enable_telemetry", "capacity"), &NEATAgent::enable_telemetry, DEFVAL(4096));
+    ClassDB::bind_method(D_METHOD("disable_telemetry"), &NEATAgent::disable_telemetry);
+    ClassDB::bind_method(D_METHOD("drain_telemetry", "max_records"), &NEATAgent::drain_telemetry, DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("get_telemetry_available"), &NEATAgent::get_telemetry_available);
+    ClassDB::bind_method(D_METHOD("start_trace", "path"), &NEATAgent::start_trace);
+    ClassDB::bind_method(D_METHOD("stop_trace"), &NEATAgent::stop_trace);
+    ClassDB::bind_method(D_METHOD("set_compact_genomes", "enabled"), &NEATAgent::set_compact_genomes);
+    ClassDB::bind_method(D_METHOD("set_species_index", "enabled", "bands", "rows"), &NEATAgent::set_species_index, DEFVAL(16), DEFVAL(2));
+    ClassDB::bind_method(D_METHOD("set_parent_selection", "mode", "tournament_size"), &NEATAgent::set_parent_selection, DEFVAL("uniform"), DEFVAL(3));
+    ClassDB::bind_method(D_METHOD("start_champion_log", "path"), &NEATAgent::start_champion_log);
+    ClassDB::bind_method(D_METHOD("stop_champion_log"), &NEATAgent::stop_champion_log);
+    ClassDB::bind_method(D_METHOD("set_substrate", "input_positions", "output_positions", "hidden_layers", "hidden_activation", "output_activation", "weight_threshold", "max_weight"), &NEATAgent::set_substrate, DEFVAL(Array()), DEFVAL("tanh"), DEFVAL("tanh"), DEFVAL(0.2), DEFVAL(3.0));
+    ClassDB::bind_method(D_METHOD("initialize_substrate_population", "population_size", "cppn_activation", "species_count", "initial_enabled_percent"), &NEATAgent::initialize_substrate_population, DEFVAL(150), DEFVAL("tanh"), DEFVAL(8), DEFVAL(0.25));
+    ClassDB::bind_method(D_METHOD("get_substrate_weight_count"), &NEATAgent::get_substrate_weight_count);
+    ClassDB::bind_method(D_METHOD("start_racing", "max_episodes", "min_episodes", "mode", "keep_fraction", "confidence"), &NEATAgent::start_racing, DEFVAL(2), DEFVAL("halving"), DEFVAL(0.5), DEFVAL(1.96));
+    ClassDB::bind_method(D_METHOD("get_racing_batch"), &NEATAgent::get_racing_batch);
+    ClassDB::bind_method(D_METHOD("add_episode_fitness", "index", "fitness"), &NEATAgent::add_episode_fitness);
+    ClassDB::bind_method(D_METHOD("is_racing"), &NEATAgent::is_racing);
+    ClassDB::bind_method(D_METHOD("get_racing_episode_count"), &NEATAgent::get_racing_episode_count);
+    ClassDB::bind_method(D_METHOD("get_network_episode_count", "index"), &NEATAgent::get_network_episode_count);
+    ClassDB::bind_method(D_METHOD("start_replay_log", "path"), &NEATAgent::start_replay_log);
+    ClassDB::bind_method(D_METHOD("stop_replay_log"), &NEATAgent::stop_replay_log);
+    ClassDB::bind_method(D_METHOD("replay_generation", "path", "generation"), &NEATAgent::replay_generation);
+}
+
+void NEATAgent::reset_run(){
+    //Shared start of initialize_population and import_template
+    this->rate_connection_mutate = 0.0;
+    this->rate_node_mutate = 0.0;
+    this->rate_enable_mutate = 0.0;
+    this->rate_weight_mutate = 0.0;
+
+    //Free the old run in the same order as the destructor, islands hand their networks back first. Any half built generation goes too
+    clear_islands();
+    for (Network* n : this->population) delete n;
+    for (Network* n : this->next_population) delete n;
+    for (Species* s : this->species) delete s;
+    delete this->global_champion;
+    this->population.clear();
+    this->next_population.clear();
+    this->species.clear();
+    this->global_champion = nullptr;
+    this->generation_phase = PHASE_IDLE;
+    this->best_performer = nullptr;
+
+    this->substrate_mode = false;
+    delete this->race; //Its entries describe the old population
+    this->race = nullptr;
+    this->registry->clear();
+
+    this->global_highest_fitness = 0.0;
+    this->generation_count = 0;
+    stop_champion_log(); //The next population may not match the log's header
+    stop_replay_log();
+
+    this->compatibility_threshold = 3.0;
+
+    this->generations_without_improvement = 0;
+    this->last_best_fitness = 0.0f;
+    this->stagnation_limit = INT_MAX;
+    this->size_cap = INT_MAX;
+    this->memory_budget = 0;
+    this->structural_growth_blocked = false;
+    if (this->novelty_archive != nullptr) this->novelty_archive->clear(this->behavior_dimensions);
+    this->fitness_cache.clear();
 }
 
 void NEATAgent::initialize_population(int inputs, int outputs, int population_size, godot::String hidden_activation, godot::String output_activation, int desired_species_count, float initial_enabled_percent){
@@ -39,30 +153,10 @@ void NEATAgent::initialize_population(int inputs, int outputs, int population_si
     ERR_FAIL_COND_MSG(this->hidden_activation != "relu" && this->hidden_activation != "linear" && this->hidden_activation != "sigmoid" && this->hidden_activation != "tanh", "NEATAgent Import Error: Hidden activation function must be \"relu\", \"linear\", \"sigmoid\", or \"tanh\"");
     ERR_FAIL_COND_MSG(this->output_activation != "relu" && this->output_activation != "linear" && this->output_activation != "sigmoid" && this->output_activation != "tanh", "NEATAgent Import Error: Output activation function must be \"relu\", \"linear\", \"sigmoid\", or \"tanh\"");
     
-    this->rate_connection_mutate = 0.0;
-    this->rate_node_mutate = 0.0;
-    this->rate_enable_mutate = 0.0;
-    this->rate_weight_mutate = 0.0;
-
-    this->population.clear();
-    this->species.clear();
-    this->innovation_table.clear();
-
-    this->global_champion = nullptr;
-    this->global_highest_fitness = 0.0;
-    this->generation_count = 0;
-
+    reset_run();
     this->desired_species_count = desired_species_count;
-    this->compatibility_threshold = 3.0;
-
-    this->generations_without_improvement = 0;
-    this->last_best_fitness = 0.0f;
-    this->stagnation_limit = INT_MAX;
-    this->size_cap = INT_MAX;
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    this->rng = gen;
+    reset_rng();
 
     //Initialize neurons
     std::vector<int> depth_data;
@@ -71,7 +165,7 @@ void NEATAgent::initialize_population(int inputs, int outputs, int population_si
         depth_data.push_back(i);
         i++;
     }
-    this->neuron_counter = i;
+    this->registry->neuron_counter = i;
 
     //Initialize conections
     std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
@@ -84,27 +178,30 @@ void NEATAgent::initialize_population(int inputs, int outputs, int population_si
 
             //Add to the innovation table
             std::pair<int, int> id_pair = {j, k};
-            this->innovation_table[id_pair] = innov_num;
+            this->registry->innovation_table[id_pair] = innov_num;
 
             innov_num++;
         }
     }
+    this->registry->innovation_counter = innov_num;
 
     //For every connection, there is a 25% chance that it will be enabled
     for (int i = 0; i < this->population_size; i++){
+        NEATRandom network_rng = network_stream(-1, i);
         std::vector<std::vector<float>> this_connection_data(connection_data);
         for (int j = 0; j < this_connection_data.size(); j++){
             //Also randomize the weight value (if more connections start enabled, initialize their weight as smaller)
-            this_connection_data[j][2] = dis(this->rng) * (1.0 - initial_enabled_percent * 0.9);
+            this_connection_data[j][2] = dis(network_rng) * (1.0 - initial_enabled_percent * 0.9);
 
-            float enabled_rand_val = (dis(this->rng) + 1.0) / 2.0;
+            float enabled_rand_val = (dis(network_rng) + 1.0) / 2.0;
             if (enabled_rand_val * 0.99999 < initial_enabled_percent){ //* 0.999 just so it can never be equal to 1.0, because 1.0 !< 1.0 and dont want to use <= because then same issue with 0
                 this_connection_data[j][3] = 1.0;
             }
         }
         //Generate the initial population
-        population.push_back(new Network(this->inputs, this->outputs, &depth_data, &this_connection_data, this->hidden_activation, this->output_activation, true, this->rng, this));
+        population.push_back(adopt_child(new Network(this->inputs, this->outputs, &depth_data, &this_connection_data, this->hidden_activation, this->output_activation, true, network_rng, this), nullptr, nullptr));
     }
+    set_genesis(replay_log::GENESIS_INITIALIZE, inputs, initial_enabled_percent);
 }
 
 void NEATAgent::import_template(Array network_data, int population_size, int desired_species_count){
@@ -156,30 +253,10 @@ void NEATAgent::import_template(Array network_data, int population_size, int des
     else if (out_fun == 2.0) this->output_activation = "sigmoid";
     else if (out_fun == 3.0) this->output_activation = "tanh";
     
-    this->rate_connection_mutate = 0.0;
-    this->rate_node_mutate = 0.0;
-    this->rate_enable_mutate = 0.0;
-    this->rate_weight_mutate = 0.0;
-
-    this->population.clear();
-    this->species.clear();
-    this->innovation_table.clear();
-
-    this->global_champion = nullptr;
-    this->global_highest_fitness = 0.0;
-    this->generation_count = 0;
-
+    reset_run();
     this->desired_species_count = desired_species_count;
-    this->compatibility_threshold = 3.0;
-
-    this->generations_without_improvement = 0;
-    this->last_best_fitness = 0.0f;
-    this->stagnation_limit = INT_MAX;
-    this->size_cap = INT_MAX;
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    this->rng = gen;
+    reset_rng();
 
     std::unordered_set<int> seen_neurons;
 
@@ -206,7 +283,7 @@ void NEATAgent::import_template(Array network_data, int population_size, int des
         depth_data.push_back(i);
     }
 
-    this->neuron_counter = depth_data.size();
+    this->registry->neuron_counter = depth_data.size();
 
     //Create the connection data with all connections enabled
     std::vector<std::vector<float>> connection_data;
@@ -221,15 +298,44 @@ void NEATAgent::import_template(Array network_data, int population_size, int des
         connection_data.push_back(connection);
 
         std::pair<int, int> id_pair = {from, to};
-        this->innovation_table[id_pair] = innov_num;
+        this->registry->innovation_table[id_pair] = innov_num;
 
         innov_num++;
     }
+    this->registry->innovation_counter = innov_num;
 
     //Create population based on imported network data
     for (int i = 0; i < this->population_size; i++){
-        population.push_back(new Network(this->inputs, this->outputs, &depth_data, &connection_data, this->hidden_activation, this->output_activation, true, this->rng, this));
+        NEATRandom network_rng = network_stream(-1, i);
+        population.push_back(adopt_child(new Network(this->inputs, this->outputs, &depth_data, &connection_data, this->hidden_activation, this->output_activation, true, network_rng, this), nullptr, nullptr));
+    }
+
+    set_genesis(replay_log::GENESIS_TEMPLATE, this->inputs, 1.0f);
+    for (const std::vector<float> &connection : connection_data) this->genesis.template_connections.push_back({(uint32_t)connection[0], (uint32_t)connection[1], connection[2]});
+}
+
+void NEATAgent::set_seed(int64_t seed){ //NOTE: Takes effect immediately and is kept by initialize_population and import_template
+    this->seed = (uint64_t)seed;
+    this->has_fixed_seed = true;
+    this->rng = NEATRandom(this->seed);
+}
+
+int64_t NEATAgent::get_seed(){
+    return (int64_t)this->seed;
+}
+
+void NEATAgent::reset_rng(){
+    //Without a fixed seed pick a fresh one, but remember it so get_seed can still reproduce the run
+    if (!this->has_fixed_seed){
+        std::random_device rd;
+        this->seed = ((uint64_t)rd() << 32) | rd();
     }
+    this->rng = NEATRandom(this->seed);
+}
+
+NEATRandom NEATAgent::network_stream(int64_t generation, int64_t index){
+    //Depends only on the seed, generation and index, so results dont change with evaluation order or thread count
+    return NEATRandom(this->seed).stream(generation, index);
 }
 
 void NEATAgent::set_mutation_rates(float rate_weight_mutate, float rate_connection_mutate, float rate_enable_mutate, float rate_node_mutate){
@@ -244,26 +350,42 @@ void NEATAgent::set_mutation_rates(float rate_weight_mutate, float rate_connecti
     this->rate_connection_mutate = rate_connection_mutate;
     this->rate_enable_mutate = rate_enable_mutate;
     this->rate_node_mutate = rate_node_mutate;
+    sync_island_settings();
 }
 
 PackedFloat32Array NEATAgent::get_network_guess(int index, PackedFloat32Array inputs){
     //Error check
     ERR_FAIL_COND_V_MSG(index < 0 || index >= this->population_size, PackedFloat32Array(), "NEATAgent Guess Error: Index must be in range 0 to population_size-1");
-    ERR_FAIL_COND_V_MSG(inputs.size() != this->inputs-1, PackedFloat32Array(), "NEATAgent Guess Error: Number of inputs is not equal to expected input size");
+    ERR_FAIL_COND_V_MSG(inputs.size() != guess_input_size(), PackedFloat32Array(), "NEATAgent Guess Error: Number of inputs is not equal to expected input size");
+
+    //In substrate mode the network is the CPPN, the guess comes from the substrate it realizes
+    Network* chosen_network = this->population[index];
+    if (this->substrate_mode){
+        PackedFloat32Array outputs;
+        outputs.resize(this->substrate->output_count());
+        realize_substrate(chosen_network)->evaluate(*this->substrate, inputs.ptr(), outputs.ptrw(), this->substrate_scratch);
+        return outputs;
+    }
 
     //Get the guess array from network at index
     std::vector<float> input_vec = NEATAgent::packed_to_vector_float(inputs);
     input_vec.push_back(1.0);
-    Network* chosen_network = this->population[index];
     std::vector<float> guess = chosen_network->guess(input_vec);
     return NEATAgent::vector_to_packed_float(guess);
 }
 
 PackedFloat32Array NEATAgent::get_champion_guess(PackedFloat32Array inputs){
     //Error check
-    ERR_FAIL_COND_V_MSG(inputs.size() != this->inputs-1, PackedFloat32Array(), "NEATAgent Guess Error: Number of inputs is not equal to expected input size");
+    ERR_FAIL_COND_V_MSG(inputs.size() != guess_input_size(), PackedFloat32Array(), "NEATAgent Guess Error: Number of inputs is not equal to expected input size");
     ERR_FAIL_COND_V_MSG(this->global_champion == nullptr, PackedFloat32Array(), "NEATAgent Champion Error: No champion yet");
 
+    if (this->substrate_mode){
+        PackedFloat32Array outputs;
+        outputs.resize(this->substrate->output_count());
+        realize_substrate(this->global_champion)->evaluate(*this->substrate, inputs.ptr(), outputs.ptrw(), this->substrate_scratch);
+        return outputs;
+    }
+
     //Get the guess array from champ network
     std::vector<float> input_vec = NEATAgent::packed_to_vector_float(inputs);
     input_vec.push_back(1.0);
@@ -275,6 +397,7 @@ void NEATAgent::set_network_fitness(int index, float fitness){
     //Error check
     ERR_FAIL_COND_MSG(index < 0 || index >= this->population_size, "NEATAgent Set Error: Index must be in range 0 to population_size-1");
     ERR_FAIL_COND_MSG(fitness <= 0.0001, "NEATAgent Set Error: Fitness must be greater than 0.0001");
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Set Error: Cannot set fitness while a generation step is in progress");
 
     //Set network at index's fitness to fitness value
     Network* chosen_network = this->population[index];
@@ -282,6 +405,63 @@ void NEATAgent::set_network_fitness(int index, float fitness){
 }
 
 void NEATAgent::next_generation(){
+    //Run (or finish) the whole generation in one call
+    while (step_generation(0) < 1.0f);
+}
+
+float NEATAgent::step_generation(int budget_usec){
+    //Budget of 0 or less means no limit
+    auto start = std::chrono::steady_clock::now();
+    NEAT_TRACE_SCOPE("step_generation", "generation");
+
+    //An unfinished race hands over the estimates it has so far
+    if (this->generation_phase == PHASE_IDLE && this->race != nullptr && this->race->active) finish_racing();
+
+    //The population can grow between generations (initialize_population, import_template), so the telemetry scratch is sized
+    //before every generation rather than once. A no-op while it is big enough
+    if (this->generation_phase == PHASE_IDLE && this->telemetry != nullptr) this->telemetry_scratch.reserve(std::max((int)this->population.size(), this->population_size));
+
+    //Islands always run a whole generation at once, spread over threads
+    if (!this->islands.empty()){
+        island_generation();
+        return 1.0f;
+    }
+
+    if (this->generation_phase == PHASE_IDLE) begin_generation();
+
+    //One trace event per phase rather than per unit of work
+    GenerationPhase traced_phase = this->generation_phase;
+    int64_t traced_start = trace::is_active() ? trace::now_ns() : -1;
+
+    while (this->generation_phase != PHASE_IDLE){
+        run_generation_unit();
+
+        if (traced_start >= 0 && this->generation_phase != traced_phase){
+            int64_t now = trace::now_ns();
+            trace::record(PHASE_TRACE_NAMES[traced_phase], "generation", traced_start, now);
+            traced_phase = this->generation_phase;
+            traced_start = now;
+        }
+
+        if (budget_usec > 0){
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            if (elapsed >= budget_usec) break;
+        }
+    }
+    if (traced_start >= 0 && traced_phase != PHASE_IDLE) trace::record(PHASE_TRACE_NAMES[traced_phase], "generation", traced_start, trace::now_ns());
+    if (this->generation_phase == PHASE_IDLE && this->replay_record_pending) finish_replay_record();
+
+    return get_generation_progress();
+}
+
+bool NEATAgent::is_generation_in_progress(){
+    return this->generation_phase != PHASE_IDLE;
+}
+
+void NEATAgent::begin_generation(){
+    //Taken before anything below can touch fitness
+    if (this->replay_log != nullptr) begin_replay_record();
+
     //Check if there was improvement from last generation
     if (this->global_highest_fitness > this->last_best_fitness) { 
         this->last_best_fitness = this->global_highest_fitness;
@@ -290,7 +470,18 @@ void NEATAgent::next_generation(){
         this->generations_without_improvement++;
     }
 
-    //If hasnt improved in stagnation_limit amount of generations, continue...
+    record_fitness_cache();
+
+    //Selection draws come from one stream per generation, every child gets its own stream (see network_stream)
+    this->rng = network_stream(this->generation_count, -1);
+
+    this->phase_cursor = 0;
+    this->species_child_cursor = 0;
+    this->best_performer = nullptr;
+    this->global_adjusted_sum = 0.0;
+    this->next_population.clear();
+
+    //If hasnt improved in stagnation_limit amount of generations, repopulate from the champion
     if (this->generations_without_improvement > stagnation_limit) {
         
         //If there is no champion, create a default network as champion
@@ -299,6 +490,37 @@ void NEATAgent::next_generation(){
             this->global_champion->fitness = 0.01;
         }
 
+        this->generation_phase = PHASE_REPOPULATE;
+        return;
+    }
+
+    this->generation_phase = this->novelty_enabled ? PHASE_NOVELTY : PHASE_SPECIATE;
+}
+
+void NEATAgent::run_generation_unit(){
+    //Each call does one small unit of work (one network, one species or one child) so the caller can stop between units
+    switch (this->generation_phase){
+
+    case PHASE_IDLE:
+        break;
+
+    case PHASE_REPOPULATE: {
+        if (this->next_population.size() < this->population_size){
+            //First keep the champion unmutated, then fill with mutants of it. The mutants line up with that first copy's genome
+            bool mutate = !this->next_population.empty();
+            Network* lineage = mutate ? this->next_population[0] : nullptr;
+            NEATRandom child_rng = network_stream(this->generation_count, this->next_population.size());
+            Network* child = new Network(this->inputs, this->outputs, &this->global_champion->get_depth_data(), &this->global_champion->get_connection_data(), this->hidden_activation, this->output_activation, mutate, child_rng, this, this->global_champion);
+            this->next_population.push_back(adopt_child(child, lineage, nullptr));
+            break;
+        }
+
+        if (this->telemetry != nullptr){
+            fill_population_telemetry(this->pending_telemetry);
+            fill_species_telemetry(this->pending_telemetry);
+            this->telemetry->push(this->pending_telemetry);
+        }
+
         //Delete current population
         for (Network* n : this->population) {
             delete n;
@@ -312,235 +534,377 @@ void NEATAgent::next_generation(){
         }
         this->species.clear();
 
-        //Keep champion in the new population
-        this->population.push_back(new Network(this->inputs, this->outputs, &this->global_champion->get_depth_data(), &this->global_champion->get_connection_data(), this->hidden_activation, this->output_activation, false, this->rng, this));
-        
-        //Repopulate from the champion
-        for (int k = 1; k < this->population_size; k++) {
-            Network* mutant = new Network(this->inputs, this->outputs, &this->global_champion->get_depth_data(), &this->global_champion->get_connection_data(), this->hidden_activation, this->output_activation, true, this->rng, this);
-            this->population.push_back(mutant);
-        }
-
+        this->population = this->next_population;
+        this->next_population.clear();
         this->generations_without_improvement = 0;
+        this->generation_count++;
+        this->generation_phase = PHASE_IDLE;
+        enforce_memory_budget();
+        apply_fitness_cache();
+        publish_shared_population();
+        break;
+    }
 
-        return;
+    case PHASE_NOVELTY: {
+        //Scores every network at once since the queries run in parallel
+        compute_novelty();
+        this->generation_phase = PHASE_SPECIATE;
+        break;
     }
 
-    Network* best_performer = nullptr;
+    case PHASE_SPECIATE: {
+        if (this->phase_cursor >= this->population.size()){
+            log_champion();
+            this->phase_cursor = 0;
+            this->generation_phase = PHASE_ADJUST;
+            break;
+        }
+
+        //Representatives only change between generations, so index them once per speciation
+        if (this->phase_cursor == 0 && this->species_index_enabled) rebuild_species_index();
 
-    //Cycle through all members of the population and assign to species
-    for (int j = 0; j < population.size(); j++){
-        Network* current_network = this->population[j];
+        Network* current_network = this->population[this->phase_cursor++];
 
         //Speciate
-        bool found = false;
-        for (Species* s : this->species) {
-            //Compatibility check
-            if (s->evaluate_compatibility(current_network) < this->compatibility_threshold) {
-                s->add_member(current_network);
-                found = true;
-                break;
-            }
+        Species* compatible = find_compatible_species(current_network);
+        if (compatible != nullptr) {
+            compatible->add_member(current_network);
         }
 
         //If a network didnt fit into any species, create a new species with this network as the representative
-        if (!found) {
+        else {
             Species* new_s = new Species();
             new_s->add_member(current_network);
             new_s->representative_genome = current_network->get_connection_data();
             this->species.push_back(new_s);
+            if (this->species_index_enabled) this->species_index->insert(this->species.size() - 1, this->signature_scratch);
         }
 
         //Get best performer out of previous generation
-        if (best_performer == nullptr || current_network->fitness > best_performer->fitness){
-            best_performer = current_network;
+        if (this->best_performer == nullptr || current_network->fitness > this->best_performer->fitness){
+            this->best_performer = current_network;
             
             //If best is better than global champion, change global champion to best
             if (current_network->fitness > this->global_highest_fitness) {
                 this->global_highest_fitness = current_network->fitness;
                 if (this->global_champion != nullptr) delete this->global_champion;
-                this->global_champion = new Network(this->inputs, this->outputs, &current_network->get_depth_data(), &current_network->get_connection_data(), this->hidden_activation, this->output_activation, false, this->rng, this);
+                this->global_champion = new Network(this->inputs, this->outputs, &current_network->get_depth_data(), &current_network->get_connection_data(), this->hidden_activation, this->output_activation, false, this->rng, this, current_network);
                 this->global_champion->fitness = current_network->fitness;
+                this->champion_log_pending = true;
             }
         }
 
+        //Speciation and the champion copy may have materialized a compact genome
+        current_network->release_genome();
+        break;
     }
 
-    //Adjust each networks fitness by the size of the species
-    for (Species* s: species){
+    case PHASE_ADJUST: {
+        if (this->phase_cursor >= this->species.size()){
+            this->phase_cursor = 0;
+            this->generation_phase = PHASE_CULL;
+            break;
+        }
+
+        //Adjust each networks fitness by the size of the species, blending in novelty when novelty search is on
+        Species* s = this->species[this->phase_cursor++];
+        s->member_count = s->networks.size();
         for (Network* network: s->networks){
-            network->adjusted_fitness = network->fitness / s->networks.size();
+            float score = network->fitness;
+            if (this->novelty_enabled) score = (1.0f - this->novelty_weight) * network->fitness + this->novelty_weight * network->novelty_score;
+            network->adjusted_fitness = score / s->networks.size();
         }
+        break;
     }
 
-    //Delete bottom 50% of networks in all species so top 50% can reproduce
-    for (Species* s: this->species){
-        if (s->networks.empty()) continue;
+    case PHASE_CULL: {
+        if (this->phase_cursor >= this->species.size()){
+            this->phase_cursor = 0;
+            this->generation_phase = PHASE_ALLOCATE;
+            break;
+        }
+
+        //Delete bottom 50% of networks in the species so top 50% can reproduce
+        Species* s = this->species[this->phase_cursor++];
+        if (s->networks.empty()) break;
         s->sort_networks();
 
         int survivors = ceil(s->networks.size() * 0.5);
         if (survivors < 1) survivors = 1;
         s->networks.resize(survivors);
+        break;
     }
 
-    for (Species* s : this->species) {
-        s->age++;
+    case PHASE_ALLOCATE: {
+        if (this->phase_cursor < this->species.size()){
+            Species* s = this->species[this->phase_cursor++];
+            s->age++;
 
-        //Check for improvement
-        float species_best = 0.0f;
-        for (Network* n : s->networks) {
-            if (n->fitness > species_best) species_best = n->fitness;
-        }
+            //Check for improvement
+            float species_best = 0.0f;
+            for (Network* n : s->networks) {
+                if (n->fitness > species_best) species_best = n->fitness;
+            }
 
-        if (species_best > s->max_fitness_ever) {
-            s->max_fitness_ever = species_best;
-            s->gens_since_improved = 0;
-        } else {
-            s->gens_since_improved++;
-        }
+            if (species_best > s->max_fitness_ever) {
+                s->max_fitness_ever = species_best;
+                s->gens_since_improved = 0;
+            } else {
+                s->gens_since_improved++;
+            }
 
-        //Give newer species a fitness bonus so they dont die too soon
-        if (s->age < 10) {
-            for (Network* n : s->networks) {
-                n->adjusted_fitness *= 1.5f;
+            //Give newer species a fitness bonus so they dont die too soon
+            if (s->age < 10) {
+                for (Network* n : s->networks) {
+                    n->adjusted_fitness *= 1.5f;
+                }
             }
-        }
 
-        //Kill species that haven't improved in 20 generations
-        if (s->age > 25 && s->gens_since_improved > 20) {
-            for (Network* n : s->networks) {
-                n->adjusted_fitness = 0.0f;
+            //Kill species that haven't improved in 20 generations
+            if (s->age > 25 && s->gens_since_improved > 20) {
+                for (Network* n : s->networks) {
+                    n->adjusted_fitness = 0.0f;
+                }
             }
+
+            build_parent_table(s);
+            break;
         }
-    }
 
-    float global_adjusted_sum = 0.0;
-    for (Species* s: this->species){
-        for (Network* network: s->networks){
-            global_adjusted_sum += network->adjusted_fitness;
+        //All species aged, so hand out offspring counts
+        this->global_adjusted_sum = 0.0;
+        for (Species* s: this->species){
+            for (Network* network: s->networks){
+                this->global_adjusted_sum += network->adjusted_fitness;
+            }
         }
-    }
 
-    for (Species* s: this->species){
-        if (global_adjusted_sum == 0.0) break;
+        for (Species* s: this->species){
+            if (this->global_adjusted_sum == 0.0) break;
 
-        //Calculate the sum for this species
-        float species_adj_sum = 0.0;
-        for (Network* network : s->networks) species_adj_sum += network->adjusted_fitness;
-        
-        //Determine offspring count
-        int offspring_count = std::floor((species_adj_sum / global_adjusted_sum) * this->population_size);
+            //Calculate the sum for this species
+            float species_adj_sum = 0.0;
+            for (Network* network : s->networks) species_adj_sum += network->adjusted_fitness;
+            
+            //Determine offspring count
+            int offspring_count = std::floor((species_adj_sum / this->global_adjusted_sum) * this->population_size);
 
-        s->offspring_count = offspring_count;
+            s->offspring_count = offspring_count;
+        }
+
+        this->phase_cursor = 0;
+        this->species_child_cursor = 0;
+        this->generation_phase = PHASE_REPRODUCE;
+        break;
     }
 
-    std::vector<Network*> next_generation; 
+    case PHASE_REPRODUCE: {
+        if (this->phase_cursor >= this->species.size()){
+            this->phase_cursor = 0;
+            this->fill_species.clear();
+            for (Species* s : this->species) {
+                if (!s->networks.empty()) this->fill_species.push_back(s);
+            }
+            this->generation_phase = PHASE_FILL;
+            break;
+        }
+
+        //Reproduce species to fill next generation, one child at a time
+        Species* s = this->species[this->phase_cursor];
+        if (s->networks.empty() || s->offspring_count <= 0){
+            s->offspring_count = 0;
+            this->species_child_cursor = 0;
+            this->phase_cursor++;
+            break;
+        }
 
-    //Reproduce species to fill nect generation
-    for (Species* s: this->species){
-        std::vector<Network*> babies = reproduce(s);
-        next_generation.insert(next_generation.end(), babies.begin(), babies.end());
+        //First child of each species is a copy of its best network
+        this->next_population.push_back(reproduce_child(s, this->species_child_cursor == 0));
+        this->species_child_cursor++;
+        s->offspring_count--;
+        break;
     }
 
-    //Since we could get a next_generation size less than population_size, we want to fill in remaining gaps
-    while (next_generation.size() < this->population_size){
+    case PHASE_FILL: {
+        //Since we could get a next_generation size less than population_size, we want to fill in remaining gaps
+        if (this->next_population.size() >= this->population_size || this->fill_species.empty()){
+            this->fill_species.clear();
+            this->generation_phase = PHASE_SWAP;
+            break;
+        }
 
-        //Pick random species
-        int s_idx = std::uniform_int_distribution<>(0, this->species.size()-1)(this->rng);
-        Species* s = this->species[s_idx];
-        
-        if (s->networks.empty()) continue;
+        //Pick random species out of the ones with survivors, so every unit adds a child
+        int s_idx = std::uniform_int_distribution<>(0, this->fill_species.size()-1)(this->rng);
+        Species* s = this->fill_species[s_idx];
 
-        //Pick random network
-        int n_idx = std::uniform_int_distribution<>(0, s->networks.size()-1)(this->rng);
-        Network* parent = s->networks[n_idx];
+        Network* parent = select_parent(s);
         
         //Create new child
-        Network* new_net = new Network(this->inputs, this->outputs, &parent->get_depth_data(), &parent->get_connection_data(), this->hidden_activation, this->output_activation, true, this->rng, this);
-        next_generation.push_back(new_net);
+        NEATRandom child_rng = network_stream(this->generation_count, this->next_population.size());
+        Network* new_net = new Network(this->inputs, this->outputs, &parent->get_depth_data(), &parent->get_connection_data(), this->hidden_activation, this->output_activation, true, child_rng, this, parent);
+        this->next_population.push_back(adopt_child(new_net, parent, nullptr));
+        break;
     }
 
-    //Update representative genomes
-    for (Species* s : this->species) {
-        if (!s->networks.empty()) {
-            int n_idx = std::uniform_int_distribution<>(0, s->networks.size()-1)(this->rng);
-            s->representative_genome = s->networks[n_idx]->get_connection_data(); //pick random network as new representative
+    case PHASE_SWAP: {
+        //Stats of the generation that was just bred from, taken before its networks go
+        if (this->telemetry != nullptr){
+            fill_population_telemetry(this->pending_telemetry);
+            fill_species_telemetry(this->pending_telemetry);
+            this->telemetry->push(this->pending_telemetry);
         }
-    }
-
-    for (Network* n : this->population) {
-        delete n;
-    }
-    this->population.clear();
 
-    // Delete empty species object
-    auto it = this->species.begin();
-    while (it != this->species.end()) {
-        if ((*it)->networks.empty()) {
-            delete *it;
-            it = this->species.erase(it);
-        } else {
-            ++it;
+        //Update representative genomes
+        for (Species* s : this->species) {
+            if (!s->networks.empty()) {
+                int n_idx = std::uniform_int_distribution<>(0, s->networks.size()-1)(this->rng);
+                s->representative_genome = s->networks[n_idx]->get_connection_data(); //pick random network as new representative
+            }
         }
-    }
 
-    for (Species* s : this->species) {
-        s->networks.clear();
-    }
+        for (Network* n : this->population) {
+            delete n;
+        }
+        this->population.clear();
+
+        // Delete empty species object
+        auto it = this->species.begin();
+        while (it != this->species.end()) {
+            if ((*it)->networks.empty()) {
+                delete *it;
+                it = this->species.erase(it);
+            } else {
+                ++it;
+            }
+        }
 
-    this->population = next_generation; 
+        for (Species* s : this->species) {
+            s->networks.clear();
+        }
 
-    //Adjust compatability threshold to make it easier or harder to join species based on the amount of species
-    int tolerance = desired_species_count / 10;
-    if (this->species.size() < this->desired_species_count - tolerance) {
-        this->compatibility_threshold -= 0.1;
-    } 
-    else if (this->species.size() > this->desired_species_count + tolerance) {
-        this->compatibility_threshold += 0.1;
+        this->population = this->next_population; 
+        this->next_population.clear();
+        this->best_performer = nullptr;
+
+        //Adjust compatability threshold to make it easier or harder to join species based on the amount of species
+        int tolerance = desired_species_count / 10;
+        if (this->species.size() < this->desired_species_count - tolerance) {
+            this->compatibility_threshold -= 0.1;
+        } 
+        else if (this->species.size() > this->desired_species_count + tolerance) {
+            this->compatibility_threshold += 0.1;
+        }
+        if (this->compatibility_threshold < 0.5) this->compatibility_threshold = 0.5;
+        if (this->compatibility_threshold > 10.0) this->compatibility_threshold = 10.0;
+
+        this->generation_count++;
+        this->generation_phase = PHASE_IDLE;
+        enforce_memory_budget();
+        apply_fitness_cache();
+        publish_shared_population();
+        break;
+    }
     }
-    if (this->compatibility_threshold < 0.5) this->compatibility_threshold = 0.5;
-    if (this->compatibility_threshold > 10.0) this->compatibility_threshold = 10.0;
-
 }
 
-std::vector<Network*> NEATAgent::reproduce(Species* s){
-    std::vector<Network*> new_networks;
+float NEATAgent::get_generation_progress(){
+    if (this->generation_phase == PHASE_IDLE) return 1.0f;
+
+    //Rough share of a generation's work spent in each phase
+    float population_fraction = this->population_size > 0 ? (float)this->next_population.size() / this->population_size : 0.0f;
+    float species_fraction = this->species.empty() ? 1.0f : (float)this->phase_cursor / this->species.size();
+    float network_fraction = this->population.empty() ? 1.0f : (float)this->phase_cursor / this->population.size();
+
+    switch (this->generation_phase){
+    case PHASE_REPOPULATE: return 0.99f * population_fraction;
+    case PHASE_NOVELTY: return 0.0f;
+    case PHASE_SPECIATE: return 0.35f * network_fraction;
+    case PHASE_ADJUST: return 0.35f + 0.05f * species_fraction;
+    case PHASE_CULL: return 0.40f + 0.05f * species_fraction;
+    case PHASE_ALLOCATE: return 0.45f + 0.05f * species_fraction;
+    case PHASE_REPRODUCE:
+    case PHASE_FILL: return 0.50f + 0.45f * population_fraction;
+    case PHASE_SWAP: return 0.95f;
+    default: return 0.0f;
+    }
+}
 
-    if (s->networks.empty()) return new_networks;
+Network* NEATAgent::reproduce_child(Species* s, bool elite){
+    NEAT_TRACE_SCOPE("reproduce_child", "evolution");
+    NEATRandom child_rng = network_stream(this->generation_count, this->next_population.size());
 
     //Add best network in species to new population
-    if (s->offspring_count >= 1){
+    if (elite){
         Network* species_best = s->networks[0];
-        new_networks.push_back(new Network(this->inputs, this->outputs, &species_best->get_depth_data(), &species_best->get_connection_data(), this->hidden_activation, this->output_activation, false, this->rng, this));
-        s->offspring_count--;
+        Network* copy = new Network(this->inputs, this->outputs, &species_best->get_depth_data(), &species_best->get_connection_data(), this->hidden_activation, this->output_activation, false, child_rng, this, species_best);
+        return adopt_child(copy, species_best, nullptr);
     }
 
     std::uniform_real_distribution<> prob(0.0, 1.0);
-    std::uniform_int_distribution<> rand_net1(0, s->networks.size()-1);
-    //Create a child of two random networks
-    for (int i = 0; i < s->offspring_count; i++){
-        Network* rand_network_1 = s->networks[rand_net1(this->rng)];
-        Network* rand_network_2 = nullptr;
-        if (prob(this->rng) < 0.02){ //2% chance to choose network from other species
-            std::uniform_int_distribution<> rand_spec(0, this->species.size()-1);
-            Species* other_species = this->species[rand_spec(this->rng)];
-            if (other_species->networks.empty()){
-                rand_network_2 = s->networks[rand_net1(this->rng)];
-            }
-            else{
-                std::uniform_int_distribution<> rand_net2(0, other_species->networks.size()-1);
-                rand_network_2 = other_species->networks[rand_net2(this->rng)];
-            }
+    //Create a child of two networks picked by the selection mode
+    Network* rand_network_1 = select_parent(s);
+    Network* rand_network_2 = nullptr;
+    if (prob(this->rng) < 0.02){ //2% chance to choose network from other species
+        std::uniform_int_distribution<> rand_spec(0, this->species.size()-1);
+        Species* other_species = this->species[rand_spec(this->rng)];
+        if (other_species->networks.empty()){
+            rand_network_2 = select_parent(s);
         }
-        else{ //Otherwise, just choose another network fromm this species
-            rand_network_2 = s->networks[rand_net1(this->rng)];
+        else{
+            rand_network_2 = select_parent(other_species);
         }
-        Network* child_net = Species::perform_crossover(rand_network_1, rand_network_2, this->rng);
-        new_networks.push_back(child_net);
     }
+    else{ //Otherwise, just choose another network fromm this species
+        rand_network_2 = select_parent(s);
+    }
+    return adopt_child(Species::perform_crossover(rand_network_1, rand_network_2, child_rng), rand_network_1, rand_network_2);
+}
+
+void NEATAgent::build_parent_table(Species* s){
+    if (this->selection_mode != SELECTION_RANK && this->selection_mode != SELECTION_PROPORTIONAL){
+        s->parent_table.clear();
+        return;
+    }
+
+    //Networks are sorted best first by PHASE_CULL. Rank gives the best of n networks weight n and the worst weight 1
+    int count = s->networks.size();
+    this->selection_weights.resize(count);
+    for (int i = 0; i < count; i++){
+        if (this->selection_mode == SELECTION_RANK) this->selection_weights[i] = count - i;
+        else this->selection_weights[i] = s->networks[i]->adjusted_fitness;
+    }
+    s->parent_table.build(this->selection_weights);
+}
+
+Network* NEATAgent::select_parent(Species* s){
+    int count = s->networks.size();
+    std::uniform_int_distribution<> any_network(0, count-1);
+
+    switch (this->selection_mode){
+    case SELECTION_TOURNAMENT: {
+        //Networks are sorted best first, so the lowest index drawn wins the tournament
+        int winner = any_network(this->rng);
+        for (int k = 1; k < this->tournament_size; k++) winner = std::min(winner, any_network(this->rng));
+        return s->networks[winner];
+    }
+    case SELECTION_RANK:
+    case SELECTION_PROPORTIONAL:
+        if (s->parent_table.size() == count) return s->networks[s->parent_table.sample(this->rng)];
+        break;
+    default:
+        break;
+    }
+    return s->networks[any_network(this->rng)];
+}
 
-    s->offspring_count = 0;
-    return new_networks;
+Network* NEATAgent::adopt_child(Network* child, Network* parent_a, Network* parent_b){
+    if (!this->compact_genomes) return child;
+
+    //Store the child as a delta on a parent's genome where it can, and drop whatever the parents materialized to build it
+    child->compact_genome(parent_a, parent_b);
+    if (parent_a != nullptr) parent_a->release_genome();
+    if (parent_b != nullptr) parent_b->release_genome();
+    return child;
 }
 
 float NEATAgent::get_champion_fitness(){
@@ -556,92 +920,450 @@ int NEATAgent::get_champion_connection_count(){
 void NEATAgent::set_stagnation_limit(int limit){
     ERR_FAIL_COND_MSG(limit < 3, "NEATAgent Set Error: limit must be greater than 2");
     this->stagnation_limit = limit;
+    sync_island_settings();
 }
 
 void NEATAgent::set_connection_size_limit(int limit){ //NOTE: Wont add connections past limit. If this value is changed and connection amount exceeds, it will remain but not add connections any more
     ERR_FAIL_COND_MSG(limit < 3, "NEATAgent Set Error: limit must be greater than 2");
     this->size_cap = limit;
+    sync_island_settings();
 }
 
-std::vector<float> NEATAgent::packed_to_vector_float(const PackedFloat32Array &array) {
-    std::vector<float> vec(array.size());
-    for (int i = 0; i < array.size(); i++) vec[i] = array[i];
-    return vec;
-}
-
-PackedFloat32Array NEATAgent::vector_to_packed_float(const std::vector<float> &vec) {
-    PackedFloat32Array array;
-    array.resize((int)vec.size());
-    for (int i = 0; i < array.size(); i++) array[i] = vec[i];
-    return array;
+bool NEATAgent::start_evaluation_workers(godot::String executable_path, int worker_count, float timeout_seconds, int batch_size, PackedStringArray arguments){
+    //Error check
+    ERR_FAIL_COND_V_MSG(worker_count < 1, false, "NEATAgent Worker Error: Worker count must be greater than 0");
+    ERR_FAIL_COND_V_MSG(timeout_seconds <= 0.0, false, "NEATAgent Worker Error: Timeout must be greater than 0");
+    ERR_FAIL_COND_V_MSG(batch_size < 1, false, "NEATAgent Worker Error: Batch size must be greater than 0");
+
+    //Accept res:// and user:// paths
+    std::string path = ProjectSettings::get_singleton()->globalize_path(executable_path).utf8().get_data();
+    std::vector<std::string> args;
+    for (int i = 0; i < arguments.size(); i++) args.push_back(arguments[i].utf8().get_data());
+
+    if (this->worker_pool == nullptr) this->worker_pool = new EvaluationWorkerPool();
+    bool started = this->worker_pool->start(path, args, worker_count, (int)(timeout_seconds * 1000.0f), batch_size);
+    ERR_FAIL_COND_V_MSG(!started, false, ("NEATAgent Worker Error: " + this->worker_pool->last_error).c_str());
+    return true;
 }
 
-Array NEATAgent::extract_champion_data() {
-    //Set the initial fields and error check
-    ERR_FAIL_COND_V_MSG(this->global_champion == nullptr, Array(), "NEATAgent Champion Error: No champion yet");
+int NEATAgent::evaluate_population_with_workers(){ //NOTE: Returns how many networks failed on every retry. Those (and any fitness at or below 0.0001) get a fitness of 0.001
+    ERR_FAIL_COND_V_MSG(this->worker_pool == nullptr || !this->worker_pool->is_running(), -1, "NEATAgent Worker Error: No evaluation workers running");
+    ERR_FAIL_COND_V_MSG(this->generation_phase != PHASE_IDLE, -1, "NEATAgent Worker Error: Cannot evaluate while a generation step is in progress");
 
-    Array network_data;
-    network_data.append(this->inputs);
-    network_data.append(this->outputs);
-    if (this->hidden_activation == "relu") network_data.append(0);
-    else if (this->hidden_activation == "linear") network_data.append(1);
-    else if (this->hidden_activation == "sigmoid") network_data.append(2);
-    else if (this->hidden_activation == "tanh") network_data.append(3);
-    if (this->output_activation == "relu") network_data.append(0);
-    else if (this->output_activation == "linear") network_data.append(1);
-    else if (this->output_activation == "sigmoid") network_data.append(2);
-    else if (this->output_activation == "tanh") network_data.append(3);
+    NEAT_TRACE_SCOPE("evaluate_population_with_workers", "inference");
 
-    //Prune network so that a connection route that doesnt have a path to an output neuron are culled
-    std::unordered_set<int> useful_nodes;
-    for (int i = 0; i < this->outputs; i++) {
-        useful_nodes.insert(this->inputs + i);
+    //Ship the compiled inference path of every network, skipping ones the fitness cache already filled in
+    std::vector<int> evaluated;
+    std::vector<std::vector<uint8_t>> payloads;
+    for (int i = 0; i < this->population.size(); i++){
+        if (this->fitness_cache_auto_fill && this->population[i]->fitness_cached) continue;
+        evaluated.push_back(i);
+        payloads.emplace_back();
+        worker_protocol::encode_network(payloads.back(), this->population[i]->encode_compiled());
     }
 
-    const std::vector<int>& depth_list = this->global_champion->ordered_by_depth;
+    std::vector<float> fitness;
+    int failed = this->worker_pool->evaluate(payloads, fitness, 0.001f);
 
-    for (int i = depth_list.size() - 1; i >= 0; i--) {
-        int neuron_id = depth_list[i];
-        
-        //Skip if this neuron is an output (already handled above)
-        if (useful_nodes.count(neuron_id)) continue;
+    for (int j = 0; j < evaluated.size(); j++){
+        this->population[evaluated[j]]->fitness = (fitness[j] > 0.0001f) ? fitness[j] : 0.001f;
+    }
 
-        Neuron* neuron = this->global_champion->neurons[neuron_id];
+    if (failed > 0) WARN_PRINT(("NEATAgent Worker Warning: " + std::to_string(failed) + " networks could not be evaluated").c_str());
+    return failed;
+}
 
-        //Check if this neuron feeds into any useful neurons
-        for (auto& conn : neuron->to_connections) {
-            int target_id = conn.first;
-            
-            //If target is useful, this neuron is useful too
-            if (useful_nodes.count(target_id)) {
-                useful_nodes.insert(neuron_id);
-                break;
-            }
-        }
-    }
+void NEATAgent::stop_evaluation_workers(){
+    if (this->worker_pool == nullptr) return;
+    delete this->worker_pool;
+    this->worker_pool = nullptr;
+}
 
-    std::unordered_map<int, int> id_map;
-    int current_mapped_id = 0;
+bool NEATAgent::publish_population_shared_memory(godot::String name){ //NOTE: Once published, every new generation is published to the same region automatically
+    std::string name_str = name.utf8().get_data();
 
-    //Flatten the connection data so that neuron ID's wont be extremely large but instead relative
+    //Error check
+    ERR_FAIL_COND_V_MSG(name_str.size() < 2 || name_str[0] != '/' || name_str.find('/', 1) != std::string::npos, false, "NEATAgent Shared Memory Error: Name must start with / and contain no other /");
+    ERR_FAIL_COND_V_MSG(this->generation_phase != PHASE_IDLE, false, "NEATAgent Shared Memory Error: Cannot publish while a generation step is in progress");
 
-    //Add inputs to map
-    for (int i = 0; i < this->inputs; i++) {
-        id_map[i] = current_mapped_id++;
+    if (this->shared_population == nullptr) this->shared_population = new SharedPopulationWriter();
+    if (!this->shared_population->is_open() || this->shared_population->name != name_str){
+        bool opened = this->shared_population->open(name_str);
+        ERR_FAIL_COND_V_MSG(!opened, false, ("NEATAgent Shared Memory Error: " + this->shared_population->last_error).c_str());
     }
 
-    //Add outputs to map
-    for (int i = 0; i < this->outputs; i++) {
-        id_map[this->inputs + i] = current_mapped_id++;
+    bool published = this->shared_population->publish(this->generation_count, this->population);
+    ERR_FAIL_COND_V_MSG(!published, false, ("NEATAgent Shared Memory Error: " + this->shared_population->last_error).c_str());
+    return true;
+}
+
+void NEATAgent::publish_shared_population(){
+    if (this->shared_population == nullptr || !this->shared_population->is_open()) return;
+    if (!this->shared_population->publish(this->generation_count, this->population)){
+        ERR_FAIL_MSG(("NEATAgent Shared Memory Error: " + this->shared_population->last_error).c_str());
     }
+}
 
-    //Add hiddens to map only if they are useful
-    for (int old_id : depth_list) {
-        //Skip inputs and outputs
-        if (id_map.count(old_id)) continue;
+int NEATAgent::read_shared_fitness(){ //NOTE: Returns how many networks had a fitness written. Networks with no result keep their current fitness
+    ERR_FAIL_COND_V_MSG(this->shared_population == nullptr || !this->shared_population->is_open(), -1, "NEATAgent Shared Memory Error: No population published");
+    ERR_FAIL_COND_V_MSG(this->generation_phase != PHASE_IDLE, -1, "NEATAgent Shared Memory Error: Cannot read fitness while a generation step is in progress");
 
-        if (useful_nodes.count(old_id)) {
-            id_map[old_id] = current_mapped_id++;
+    std::vector<float> fitness;
+    this->shared_population->read_results(fitness);
+
+    int assigned = 0;
+    for (int i = 0; i < fitness.size() && i < this->population.size(); i++){
+        if (!(fitness[i] > 0.0001f)) continue;
+        this->population[i]->fitness = fitness[i];
+        assigned++;
+    }
+    return assigned;
+}
+
+void NEATAgent::close_population_shared_memory(){
+    if (this->shared_population == nullptr) return;
+    delete this->shared_population;
+    this->shared_population = nullptr;
+}
+
+void NEATAgent::set_island_mode(int island_count, int migration_interval, int migration_size, godot::String topology){ //NOTE: Splits the current population, so call after initialize_population or import_template. island_count of 1 merges the islands back
+    std::string topology_str = topology.utf8().get_data();
+
+    //Error check
+    ERR_FAIL_COND_MSG(this->population.empty(), "NEATAgent Island Error: Initialize or import a population before enabling island mode");
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Island Error: Cannot change island mode while a generation step is in progress");
+    ERR_FAIL_COND_MSG(island_count < 1, "NEATAgent Island Error: Island count must be greater than 0");
+    ERR_FAIL_COND_MSG(this->population.size() / island_count < 10, "NEATAgent Island Error: Every island needs at least 10 networks");
+    ERR_FAIL_COND_MSG(migration_interval < 1, "NEATAgent Island Error: Migration interval must be greater than 0");
+    ERR_FAIL_COND_MSG(migration_size < 0 || migration_size > (int)(this->population.size() / island_count) / 2, "NEATAgent Island Error: Migration size must be in range 0 to half an island");
+    ERR_FAIL_COND_MSG(topology_str != "ring" && topology_str != "random" && topology_str != "fully_connected", "NEATAgent Island Error: Topology must be \"ring\", \"random\", or \"fully_connected\"");
+
+    //Always start from one population
+    clear_islands();
+
+    this->migration_interval = migration_interval;
+    this->migration_size = migration_size;
+    this->migration_topology = topology_str;
+
+    if (island_count == 1) return;
+    stop_replay_log(); //Islands breed on their own streams, which the log doesnt cover
+
+    //Host species are replaced by each island's own species
+    for (Species* s : this->species) {
+        s->networks.clear();
+        delete s;
+    }
+    this->species.clear();
+
+    std::vector<Network*> all_networks = this->population;
+    int total = all_networks.size();
+
+    for (int k = 0; k < island_count; k++){
+        NEATAgent* island = memnew(NEATAgent);
+
+        //Same problem and settings, but its own species, threshold and random stream. Innovations are shared with every island
+        island->registry = this->registry;
+        island->inputs = this->inputs;
+        island->outputs = this->outputs;
+        island->hidden_activation = this->hidden_activation;
+        island->output_activation = this->output_activation;
+        island->desired_species_count = std::max(2, (this->desired_species_count + island_count - 1) / island_count);
+        island->compatibility_threshold = this->compatibility_threshold;
+        island->generation_count = this->generation_count;
+        island->global_highest_fitness = 0.0;
+        island->generations_without_improvement = 0;
+        island->last_best_fitness = 0.0f;
+        island->set_seed((int64_t)network_stream(-2, k)());
+
+        int begin = (int)((int64_t)k * total / island_count);
+        int end = (int)((int64_t)(k + 1) * total / island_count);
+        island->population.assign(all_networks.begin() + begin, all_networks.begin() + end);
+        island->population_size = end - begin;
+        for (Network* n : island->population) n->parent_agent = island;
+
+        this->islands.push_back(island);
+    }
+
+    sync_island_settings();
+}
+
+int NEATAgent::get_island_count(){
+    return this->islands.empty() ? 1 : this->islands.size();
+}
+
+void NEATAgent::island_generation(){
+    NEAT_TRACE_SCOPE("island_generation", "generation");
+    //The islands breed from the shared population, so the cache lives here rather than on each island
+    record_fitness_cache();
+
+    //Islands free these networks while they breed, so take the population half of the stats now
+    if (this->telemetry != nullptr) fill_population_telemetry(this->pending_telemetry);
+
+    //Exchange genomes before breeding so migrants keep their fitness and compete in their new island's speciation
+    if (this->generation_count > 0 && this->generation_count % this->migration_interval == 0) migrate_between_islands();
+
+    parallel_for(this->islands.size(), this->islands.size(), [this](int i) {
+        NEAT_TRACE_SCOPE("island", "generation");
+        this->islands[i]->next_generation();
+    });
+
+    //Keep the best champion found on any island
+    for (NEATAgent* island : this->islands){
+        if (island->global_champion == nullptr || island->global_highest_fitness <= this->global_highest_fitness) continue;
+
+        this->global_highest_fitness = island->global_highest_fitness;
+        if (this->global_champion != nullptr) delete this->global_champion;
+        this->global_champion = new Network(this->inputs, this->outputs, &island->global_champion->get_depth_data(), &island->global_champion->get_connection_data(), this->hidden_activation, this->output_activation, false, this->rng, this, island->global_champion);
+        this->global_champion->fitness = island->global_highest_fitness;
+        this->champion_log_pending = true;
+    }
+    log_champion();
+
+    if (this->telemetry != nullptr){
+        fill_species_telemetry(this->pending_telemetry);
+        this->telemetry->push(this->pending_telemetry);
+    }
+
+    gather_island_population();
+    this->generation_count++;
+    enforce_memory_budget();
+    apply_fitness_cache();
+    publish_shared_population();
+}
+
+void NEATAgent::migrate_between_islands(){
+    NEAT_TRACE_SCOPE("migrate_between_islands", "generation");
+    int island_count = this->islands.size();
+    if (this->migration_size == 0) return;
+
+    //Best networks of every island, taken before any island changes
+    std::vector<std::vector<Network*>> best_of_island(island_count);
+    for (int i = 0; i < island_count; i++){
+        best_of_island[i] = this->islands[i]->population;
+        std::sort(best_of_island[i].begin(), best_of_island[i].end(), [](Network* a, Network* b) {
+            return a->fitness > b->fitness;
+        });
+    }
+
+    //Copy the migrants each island receives
+    std::vector<std::vector<Network*>> arrivals(island_count);
+    for (int d = 0; d < island_count; d++){
+        NEATAgent* destination = this->islands[d];
+        std::vector<Network*> candidates;
+
+        if (this->migration_topology == "ring"){
+            candidates = best_of_island[(d - 1 + island_count) % island_count];
+        }
+        else if (this->migration_topology == "random"){
+            int source = std::uniform_int_distribution<>(0, island_count - 2)(this->rng);
+            if (source >= d) source++;
+            candidates = best_of_island[source];
+        }
+        else{
+            //Fully connected, so the best of everyone else
+            for (int s = 0; s < island_count; s++){
+                if (s == d) continue;
+                candidates.insert(candidates.end(), best_of_island[s].begin(), best_of_island[s].begin() + this->migration_size);
+            }
+            std::sort(candidates.begin(), candidates.end(), [](Network* a, Network* b) {
+                return a->fitness > b->fitness;
+            });
+        }
+
+        for (int m = 0; m < this->migration_size && m < candidates.size(); m++){
+            Network* migrant = candidates[m];
+            Network* copy = new Network(this->inputs, this->outputs, &migrant->get_depth_data(), &migrant->get_connection_data(), this->hidden_activation, this->output_activation, false, this->rng, destination, migrant);
+            copy->fitness = migrant->fitness;
+            arrivals[d].push_back(destination->adopt_child(copy, migrant, nullptr));
+        }
+    }
+
+    //Migrants replace the worst networks of their new island
+    for (int d = 0; d < island_count; d++){
+        std::vector<Network*> &island_population = this->islands[d]->population;
+        std::vector<int> order(island_population.size());
+        for (int i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&island_population](int a, int b) {
+            return island_population[a]->fitness < island_population[b]->fitness;
+        });
+
+        for (int m = 0; m < arrivals[d].size(); m++){
+            delete island_population[order[m]];
+            island_population[order[m]] = arrivals[d][m];
+        }
+    }
+}
+
+void NEATAgent::gather_island_population(){
+    //Global indices run through the islands in order
+    this->population.clear();
+    for (NEATAgent* island : this->islands){
+        this->population.insert(this->population.end(), island->population.begin(), island->population.end());
+    }
+    this->population_size = this->population.size();
+}
+
+void NEATAgent::sync_island_settings(){
+    for (NEATAgent* island : this->islands){
+        island->rate_weight_mutate = this->rate_weight_mutate;
+        island->rate_connection_mutate = this->rate_connection_mutate;
+        island->rate_enable_mutate = this->rate_enable_mutate;
+        island->rate_node_mutate = this->rate_node_mutate;
+        island->size_cap = this->size_cap;
+        island->stagnation_limit = this->stagnation_limit;
+        island->structural_growth_blocked = this->structural_growth_blocked;
+        island->novelty_enabled = this->novelty_enabled;
+        island->behavior_dimensions = this->behavior_dimensions;
+        island->novelty_weight = this->novelty_weight;
+        island->novelty_neighbors = this->novelty_neighbors;
+        island->archive_threshold = this->archive_threshold;
+        island->max_archive_size = this->max_archive_size;
+        island->compact_genomes = this->compact_genomes;
+        island->species_index_enabled = this->species_index_enabled;
+        island->species_index_bands = this->species_index_bands;
+        island->species_index_rows = this->species_index_rows;
+        island->selection_mode = this->selection_mode;
+        island->tournament_size = this->tournament_size;
+    }
+}
+
+void NEATAgent::clear_islands(){
+    if (this->islands.empty()) return;
+
+    //Take the networks back from the islands and drop everything else they own
+    gather_island_population();
+    for (Network* n : this->population) n->parent_agent = this;
+
+    for (NEATAgent* island : this->islands){
+        for (Species* s : island->species) {
+            s->networks.clear();
+            delete s;
+        }
+        island->species.clear();
+        island->population.clear();
+        if (island->global_champion != nullptr) delete island->global_champion;
+        island->global_champion = nullptr;
+        memdelete(island);
+    }
+    this->islands.clear();
+}
+
+std::vector<float> NEATAgent::packed_to_vector_float(const PackedFloat32Array &array) {
+    std::vector<float> vec(array.size());
+    for (int i = 0; i < array.size(); i++) vec[i] = array[i];
+    return vec;
+}
+
+PackedFloat32Array NEATAgent::vector_to_packed_float(const std::vector<float> &vec) {
+    PackedFloat32Array array;
+    array.resize((int)vec.size());
+    for (int i = 0; i < array.size(); i++) array[i] = vec[i];
+    return array;
+}
+
+Array NEATAgent::extract_champion_data() {
+    //Set the initial fields and error check
+    ERR_FAIL_COND_V_MSG(this->global_champion == nullptr, Array(), "NEATAgent Champion Error: No champion yet");
+
+    Array network_data;
+    network_data.append(this->inputs);
+    network_data.append(this->outputs);
+    if (this->hidden_activation == "relu") network_data.append(0);
+    else if (this->hidden_activation == "linear") network_data.append(1);
+    else if (this->hidden_activation == "sigmoid") network_data.append(2);
+    else if (this->hidden_activation == "tanh") network_data.append(3);
+    if (this->output_activation == "relu") network_data.append(0);
+    else if (this->output_activation == "linear") network_data.append(1);
+    else if (this->output_activation == "sigmoid") network_data.append(2);
+    else if (this->output_activation == "tanh") network_data.append(3);
+
+    std::vector<champion_log::Connection> connections;
+    prune_network(this->global_champion, connections);
+    for (const champion_log::Connection& connection : connections) {
+        Array connection_array;
+        connection_array.append((int)connection.from);
+        connection_array.append((int)connection.to);
+        connection_array.append(connection.weight);
+
+        network_data.append(connection_array);
+    }
+    return network_data;
+}
+
+Ref<NEATModel> NEATAgent::extract_champion_model() { //NOTE: Same network as extract_champion_data, ready to save as a .neatmodel or to create agents from
+    ERR_FAIL_COND_V_MSG(this->global_champion == nullptr, Ref<NEATModel>(), "NEATAgent Champion Error: No champion yet");
+
+    champion_log::Header header = {(uint32_t)this->inputs, (uint32_t)this->outputs, (uint32_t)Network::activation_code(this->hidden_activation), (uint32_t)Network::activation_code(this->output_activation)};
+    std::vector<champion_log::Connection> connections;
+    prune_network(this->global_champion, connections);
+
+    Ref<NEATModel> model;
+    model.instantiate();
+    model->model = network_model::acquire(header, connections);
+    return model;
+}
+
+void NEATAgent::prune_network(Network* network, std::vector<champion_log::Connection> &connections) {
+    connections.clear();
+
+    //Prune network so that a connection route that doesnt have a path to an output neuron are culled
+    std::unordered_set<int> useful_nodes;
+    for (int i = 0; i < this->outputs; i++) {
+        useful_nodes.insert(this->inputs + i);
+    }
+
+    const std::vector<int>& depth_list = network->ordered_by_depth;
+
+    //Enabled connections of each neuron, a repeated from/to pair keeps its last weight
+    std::unordered_set<int> champion_neurons(depth_list.begin(), depth_list.end());
+    std::unordered_map<int, std::map<int, float>> to_connections;
+    for (const std::vector<float>& connection : network->get_connection_data()) {
+        int from = (int)connection[0];
+        int to = (int)connection[1];
+        if (connection[3] == 0.0f || !champion_neurons.count(from) || !champion_neurons.count(to)) continue;
+        to_connections[from][to] = connection[2];
+    }
+
+    for (int i = depth_list.size() - 1; i >= 0; i--) {
+        int neuron_id = depth_list[i];
+        
+        //Skip if this neuron is an output (already handled above)
+        if (useful_nodes.count(neuron_id)) continue;
+
+        //Check if this neuron feeds into any useful neurons
+        for (auto& conn : to_connections[neuron_id]) {
+            int target_id = conn.first;
+            
+            //If target is useful, this neuron is useful too
+            if (useful_nodes.count(target_id)) {
+                useful_nodes.insert(neuron_id);
+                break;
+            }
+        }
+    }
+
+    std::unordered_map<int, int> id_map;
+    int current_mapped_id = 0;
+
+    //Flatten the connection data so that neuron ID's wont be extremely large but instead relative
+
+    //Add inputs to map
+    for (int i = 0; i < this->inputs; i++) {
+        id_map[i] = current_mapped_id++;
+    }
+
+    //Add outputs to map
+    for (int i = 0; i < this->outputs; i++) {
+        id_map[this->inputs + i] = current_mapped_id++;
+    }
+
+    //Add hiddens to map only if they are useful
+    for (int old_id : depth_list) {
+        //Skip inputs and outputs
+        if (id_map.count(old_id)) continue;
+
+        if (useful_nodes.count(old_id)) {
+            id_map[old_id] = current_mapped_id++;
         }
     }
 
@@ -649,33 +1371,27 @@ Array NEATAgent::extract_champion_data() {
         // Skip nodes we decided were useless
         if (id_map.count(neuron_id) == 0) continue;
 
-        Neuron* neuron = this->global_champion->neurons[neuron_id];
-        
-        for (auto& connection : neuron->to_connections) {
+        for (auto& connection : to_connections[neuron_id]) {
             
             // Create connections. Skip ones that connect to useless nodes (dead end)
-            if (id_map.count(neuron->id) && id_map.count(connection.first)) {
+            if (id_map.count(neuron_id) && id_map.count(connection.first)) {
                 
-                int new_from = id_map[neuron->id];
+                int new_from = id_map[neuron_id];
                 int new_to   = id_map[connection.first];
                 float weight = connection.second;
 
-                Array connection_array;
-                connection_array.append(new_from);
-                connection_array.append(new_to);
-                connection_array.append(weight);
-                
-                network_data.append(connection_array);
+                connections.push_back({(uint32_t)new_from, (uint32_t)new_to, weight});
             }
         }
     }
-    return network_data;
 }
 
 void NEATAgent::force_champion_reset(){
+    delete this->global_champion;
     this->global_champion = nullptr;
     this->global_highest_fitness = 0.0;
     this->generations_without_improvement = 0;
+    this->replay_events |= replay_log::FLAG_CHAMPION_RESET;
 }
 
 bool NEATAgent::has_champion(){
@@ -685,5 +1401,1024 @@ bool NEATAgent::has_champion(){
     return true;
 }
 
-NEATAgent::NEATAgent(){}
-NEATAgent::~NEATAgent(){}
\ No newline at end of file
+void NEATAgent::measure_memory(size_t &genomes, size_t &phenotypes, size_t &species_bytes, size_t &innovation_bytes, size_t &archive_bytes, size_t &cache_bytes, size_t &race_bytes){
+    genomes = 0;
+    phenotypes = 0;
+
+    //Every network the agent owns, including a half built generation and the champion
+    std::vector<Network*> owned = this->population;
+    owned.insert(owned.end(), this->next_population.begin(), this->next_population.end());
+    if (this->global_champion != nullptr) owned.push_back(this->global_champion);
+
+    for (Network* n : owned) {
+        genomes += n->get_genome_memory_usage();
+        phenotypes += n->get_phenotype_memory_usage();
+    }
+    phenotypes += memory_usage::vector_bytes(this->population) + memory_usage::vector_bytes(this->next_population);
+
+    species_bytes = memory_usage::vector_bytes(this->species);
+    for (Species* s : this->species) species_bytes += s->get_memory_usage();
+
+    //Island networks are already in population, but their species and champions are not
+    for (NEATAgent* island : this->islands) {
+        for (Species* s : island->species) species_bytes += s->get_memory_usage();
+        if (island->global_champion != nullptr) {
+            genomes += island->global_champion->get_genome_memory_usage();
+            phenotypes += island->global_champion->get_phenotype_memory_usage();
+        }
+    }
+
+    innovation_bytes = this->registry->get_memory_usage();
+
+    archive_bytes = this->novelty_archive != nullptr ? this->novelty_archive->get_memory_usage() : 0;
+    for (NEATAgent* island : this->islands) {
+        if (island->novelty_archive != nullptr) archive_bytes += island->novelty_archive->get_memory_usage();
+    }
+
+    cache_bytes = memory_usage::unordered_map_bytes(this->fitness_cache);
+    race_bytes = this->race != nullptr ? this->race->get_memory_usage() + memory_usage::vector_bytes(this->race_batch_scratch) : 0;
+}
+
+size_t NEATAgent::get_total_memory_usage(){
+    size_t genomes, phenotypes, species_bytes, innovation_bytes, archive_bytes, cache_bytes, race_bytes;
+    measure_memory(genomes, phenotypes, species_bytes, innovation_bytes, archive_bytes, cache_bytes, race_bytes);
+    return genomes + phenotypes + species_bytes + innovation_bytes + archive_bytes + cache_bytes + race_bytes;
+}
+
+Dictionary NEATAgent::get_memory_usage(){
+    size_t genomes, phenotypes, species_bytes, innovation_bytes, archive_bytes, cache_bytes, race_bytes;
+    measure_memory(genomes, phenotypes, species_bytes, innovation_bytes, archive_bytes, cache_bytes, race_bytes);
+
+    Dictionary usage;
+    usage["genomes"] = (int64_t)genomes;
+    usage["phenotypes"] = (int64_t)phenotypes;
+    usage["species"] = (int64_t)species_bytes;
+    usage["innovation_table"] = (int64_t)innovation_bytes;
+    usage["novelty_archive"] = (int64_t)archive_bytes;
+    usage["fitness_cache"] = (int64_t)cache_bytes;
+    usage["evaluation_race"] = (int64_t)race_bytes;
+    usage["total"] = (int64_t)(genomes + phenotypes + species_bytes + innovation_bytes + archive_bytes + cache_bytes + race_bytes);
+    usage["budget"] = this->memory_budget;
+    usage["structural_growth_blocked"] = this->structural_growth_blocked;
+    return usage;
+}
+
+void NEATAgent::set_memory_budget(int64_t bytes){ //NOTE: 0 means no budget. Checked after every generation, so a generation being built can briefly use up to twice the population
+    ERR_FAIL_COND_MSG(bytes < 0, "NEATAgent Set Error: Memory budget must be 0 (no budget) or greater");
+    this->memory_budget = bytes;
+    enforce_memory_budget();
+}
+
+void NEATAgent::enforce_memory_budget(){
+    if (this->memory_budget <= 0 || get_total_memory_usage() <= (size_t)this->memory_budget) {
+        this->structural_growth_blocked = false;
+        for (NEATAgent* island : this->islands) island->structural_growth_blocked = false;
+        return;
+    }
+
+    //Over budget so first try giving back spare capacity
+    for (Network* n : this->population) n->compact_memory();
+    if (this->global_champion != nullptr) this->global_champion->compact_memory();
+    for (Species* s : this->species) s->representative_genome.shrink_to_fit();
+    compact_innovation_table();
+    this->replay_events |= replay_log::FLAG_INNOVATIONS_COMPACTED;
+
+    //Then forget cached fitness, the genomes seen longest ago first. The last pass empties the cache and gives back its buckets
+    for (int age = this->fitness_cache_max_age; age >= 0 && !this->fitness_cache.empty() && get_total_memory_usage() > (size_t)this->memory_budget; age--){
+        auto it = this->fitness_cache.begin();
+        while (it != this->fitness_cache.end()) {
+            if (this->generation_count - it->second.last_generation >= age) it = this->fitness_cache.erase(it);
+            else ++it;
+        }
+        if (this->fitness_cache.empty()) std::unordered_map<uint64_t, CachedFitness>().swap(this->fitness_cache);
+    }
+
+    //If still over budget, stop networks from adding neurons and connections until usage drops again
+    this->structural_growth_blocked = get_total_memory_usage() > (size_t)this->memory_budget;
+    for (NEATAgent* island : this->islands) island->structural_growth_blocked = this->structural_growth_blocked;
+}
+
+void NEATAgent::compact_innovation_table(){
+    std::set<std::pair<int, int>> in_use;
+    auto collect = [&in_use](const std::vector<std::vector<float>> &genes) {
+        for (const std::vector<float> &gene : genes) in_use.insert({(int)gene[0], (int)gene[1]});
+    };
+
+    for (Network* n : this->population) {
+        collect(n->get_connection_data());
+        n->release_genome();
+    }
+    for (Network* n : this->next_population) {
+        collect(n->get_connection_data());
+        n->release_genome();
+    }
+    if (this->global_champion != nullptr) collect(this->global_champion->get_connection_data());
+    for (Species* s : this->species) collect(s->representative_genome);
+    for (NEATAgent* island : this->islands) {
+        if (island->global_champion != nullptr) collect(island->global_champion->get_connection_data());
+        for (Species* s : island->species) collect(s->representative_genome);
+    }
+
+    this->registry->compact(in_use);
+}
+
+void NEATAgent::enable_novelty_search(int behavior_dimensions, float novelty_weight, int neighbors, float archive_threshold, int max_archive_size){ //NOTE: Behaviors are only kept for networks given one with set_network_behavior, the rest get a novelty of 0
+    ERR_FAIL_COND_MSG(behavior_dimensions < 1, "NEATAgent Novelty Error: Behavior dimensions must be greater than 0");
+    ERR_FAIL_COND_MSG(novelty_weight < 0.0 || novelty_weight > 1.0, "NEATAgent Novelty Error: Novelty weight must be in range 0.0 to 1.0");
+    ERR_FAIL_COND_MSG(neighbors < 1, "NEATAgent Novelty Error: Neighbors must be greater than 0");
+    ERR_FAIL_COND_MSG(archive_threshold < 0.0, "NEATAgent Novelty Error: Archive threshold must be 0.0 or greater");
+    ERR_FAIL_COND_MSG(max_archive_size < 0, "NEATAgent Novelty Error: Max archive size must be 0 or greater");
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Novelty Error: Cannot change novelty search while a generation step is in progress");
+
+    //A new behavior space makes the old archive meaningless
+    if (behavior_dimensions != this->behavior_dimensions && this->novelty_archive != nullptr) this->novelty_archive->clear(behavior_dimensions);
+    for (NEATAgent* island : this->islands) {
+        if (island->novelty_archive != nullptr && behavior_dimensions != island->behavior_dimensions) island->novelty_archive->clear(behavior_dimensions);
+    }
+
+    stop_replay_log(); //Novelty depends on behaviors, which the log doesnt keep
+    this->novelty_enabled = true;
+    this->behavior_dimensions = behavior_dimensions;
+    this->novelty_weight = novelty_weight;
+    this->novelty_neighbors = neighbors;
+    this->archive_threshold = archive_threshold;
+    this->max_archive_size = max_archive_size;
+    sync_island_settings();
+}
+
+void NEATAgent::disable_novelty_search(){
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Novelty Error: Cannot change novelty search while a generation step is in progress");
+    this->novelty_enabled = false;
+    sync_island_settings();
+}
+
+void NEATAgent::set_network_behavior(int index, PackedFloat32Array behavior){
+    ERR_FAIL_COND_MSG(!this->novelty_enabled, "NEATAgent Novelty Error: Novelty search is not enabled");
+    ERR_FAIL_COND_MSG(index < 0 || index >= this->population.size(), "NEATAgent Novelty Error: Index must be in range 0 to population_size-1");
+    ERR_FAIL_COND_MSG(behavior.size() != this->behavior_dimensions, "NEATAgent Novelty Error: Behavior size must match behavior_dimensions");
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Novelty Error: Cannot set behavior while a generation step is in progress");
+
+    this->population[index]->behavior = NEATAgent::packed_to_vector_float(behavior);
+}
+
+float NEATAgent::get_network_novelty(int index){
+    ERR_FAIL_COND_V_MSG(index < 0 || index >= this->population.size(), 0.0f, "NEATAgent Novelty Error: Index must be in range 0 to population_size-1");
+    return this->population[index]->novelty;
+}
+
+int NEATAgent::get_novelty_archive_size(){
+    int total = this->novelty_archive != nullptr ? this->novelty_archive->size() : 0;
+    for (NEATAgent* island : this->islands) {
+        if (island->novelty_archive != nullptr) total += island->novelty_archive->size();
+    }
+    return total;
+}
+
+void NEATAgent::compute_novelty(){
+    NEAT_TRACE_SCOPE("compute_novelty", "evolution");
+    if (this->novelty_archive == nullptr) {
+        this->novelty_archive = new BehaviorArchive();
+        this->novelty_archive->clear(this->behavior_dimensions);
+    }
+    BehaviorArchive* archive = this->novelty_archive;
+    int dims = this->behavior_dimensions;
+
+    //Pack the behaviors that were reported this generation into one array for the population tree
+    std::vector<Network*> scored;
+    std::vector<float> points;
+    for (Network* n : this->population){
+        n->novelty = 0.0f;
+        n->novelty_score = 0.0f;
+        if (n->behavior.size() != dims) continue;
+        scored.push_back(n);
+        points.insert(points.end(), n->behavior.begin(), n->behavior.end());
+    }
+    if (scored.empty()) return;
+
+    archive->refresh_index();
+    KDTree population_tree;
+    population_tree.build(points.data(), scored.size(), dims);
+
+    //Novelty is the mean distance to the k nearest behaviors among the archive and the rest of the population
+    int k = this->novelty_neighbors;
+    parallel_for(scored.size(), 0, [&](int i) {
+        const float* query = points.data() + (size_t)i * dims;
+        std::vector<float> heap;
+        heap.reserve(k);
+        archive->nearest(query, k, heap);
+        population_tree.nearest(points.data(), query, k, i, heap);
+
+        float sum = 0.0f;
+        for (float d : heap) sum += std::sqrt(d);
+        scored[i]->novelty = heap.empty() ? 0.0f : sum / heap.size();
+    });
+
+    //Rescale novelty onto the fitness range so novelty_weight blends like for like
+    float max_fitness = 0.0f;
+    float max_novelty = 0.0f;
+    for (Network* n : this->population) max_fitness = std::max(max_fitness, n->fitness);
+    for (Network* n : scored) max_novelty = std::max(max_novelty, n->novelty);
+    for (Network* n : scored) n->novelty_score = max_novelty > 0.0f ? n->novelty / max_novelty * max_fitness : 0.0f;
+
+    //Archive the behaviors that stood out, then nudge the threshold so roughly a few percent get in each generation
+    int added = 0;
+    for (int i = 0; i < scored.size(); i++){
+        if (scored[i]->novelty <= this->archive_threshold) continue;
+        archive->add(points.data() + (size_t)i * dims);
+        added++;
+    }
+    if (added > std::max(1, (int)(scored.size() * 0.05f))) this->archive_threshold *= 1.2f;
+    else if (added == 0) this->archive_threshold *= 0.95f;
+
+    archive->trim(this->max_archive_size);
+}
+
+void NEATAgent::enable_fitness_cache(bool auto_fill, int max_age_generations){ //NOTE: Only use for deterministic tasks, a cached genome is assumed to score the same every time
+    ERR_FAIL_COND_MSG(max_age_generations < 1, "NEATAgent Cache Error: Max age must be greater than 0");
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Cache Error: Cannot change the fitness cache while a generation step is in progress");
+
+    this->fitness_cache_enabled = true;
+    this->fitness_cache_auto_fill = auto_fill;
+    this->fitness_cache_max_age = max_age_generations;
+}
+
+void NEATAgent::disable_fitness_cache(){
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Cache Error: Cannot change the fitness cache while a generation step is in progress");
+    this->fitness_cache_enabled = false;
+    this->fitness_cache_auto_fill = false;
+    this->fitness_cache.clear();
+    for (Network* n : this->population) n->fitness_cached = false;
+}
+
+PackedInt32Array NEATAgent::get_cached_network_indices(){
+    PackedInt32Array indices;
+    for (int i = 0; i < this->population.size(); i++){
+        if (this->population[i]->fitness_cached) indices.push_back(i);
+    }
+    return indices;
+}
+
+int64_t NEATAgent::get_network_genome_hash(int index){
+    ERR_FAIL_COND_V_MSG(index < 0 || index >= this->population.size(), 0, "NEATAgent Cache Error: Index must be in range 0 to population_size-1");
+    return (int64_t)this->population[index]->genome_hash;
+}
+
+void NEATAgent::record_fitness_cache(){
+    if (!this->fitness_cache_enabled) return;
+
+    //Fitness is final once a generation starts, latest evaluation wins if a genome was scored again
+    for (Network* n : this->population){
+        if (n->fitness <= 0.0001f) continue;
+        this->fitness_cache[n->genome_hash] = {n->fitness, this->generation_count};
+    }
+
+    //Forget genomes that havent shown up for a while
+    auto it = this->fitness_cache.begin();
+    while (it != this->fitness_cache.end()) {
+        if (this->generation_count - it->second.last_generation > this->fitness_cache_max_age) it = this->fitness_cache.erase(it);
+        else ++it;
+    }
+}
+
+void NEATAgent::apply_fitness_cache(){
+    if (!this->fitness_cache_enabled) return;
+
+    for (Network* n : this->population){
+        auto it = this->fitness_cache.find(n->genome_hash);
+        n->fitness_cached = it != this->fitness_cache.end();
+        if (!n->fitness_cached) continue;
+
+        it->second.last_generation = this->generation_count;
+        if (this->fitness_cache_auto_fill) n->fitness = it->second.fitness;
+    }
+}
+
+bool NEATAgent::set_dataset(PackedFloat32Array inputs, PackedFloat32Array targets){ //NOTE: Rows are packed back to back, inputs without the bias
+    ERR_FAIL_COND_V_MSG(this->population.empty(), false, "NEATAgent Dataset Error: Initialize or import a population before setting a dataset");
+
+    if (this->dataset == nullptr) this->dataset = new Dataset();
+    bool loaded = this->dataset->set_arrays(NEATAgent::packed_to_vector_float(inputs), NEATAgent::packed_to_vector_float(targets), guess_input_size(), guess_output_size());
+    ERR_FAIL_COND_V_MSG(!loaded, false, ("NEATAgent Dataset Error: " + this->dataset->last_error).c_str());
+    return true;
+}
+
+bool NEATAgent::load_dataset_file(godot::String path){ //NOTE: The file is memory mapped rather than read in, see Dataset.h for the layout
+    ERR_FAIL_COND_V_MSG(this->population.empty(), false, "NEATAgent Dataset Error: Initialize or import a population before loading a dataset");
+    std::string path_str = ProjectSettings::get_singleton()->globalize_path(path).utf8().get_data();
+
+    if (this->dataset == nullptr) this->dataset = new Dataset();
+    bool loaded = this->dataset->map_file(path_str);
+    ERR_FAIL_COND_V_MSG(!loaded, false, ("NEATAgent Dataset Error: " + this->dataset->last_error).c_str());
+
+    if (this->dataset->input_size != guess_input_size() || this->dataset->target_size != guess_output_size()){
+        this->dataset->clear();
+        ERR_FAIL_V_MSG(false, "NEATAgent Dataset Error: Dataset input and target sizes must match the network inputs and outputs");
+    }
+    return true;
+}
+
+void NEATAgent::clear_dataset(){
+    if (this->dataset != nullptr) this->dataset->clear();
+}
+
+int NEATAgent::get_dataset_size(){
+    return this->dataset != nullptr ? this->dataset->rows : 0;
+}
+
+float NEATAgent::evaluate_dataset(godot::String loss, int batch_size){ //NOTE: Returns the best loss (or accuracy) in the population. batch_size of 0 uses every row
+    std::string loss_str = loss.utf8().get_data();
+
+    //Error check
+    ERR_FAIL_COND_V_MSG(this->dataset == nullptr || !this->dataset->is_loaded(), -1.0f, "NEATAgent Dataset Error: No dataset loaded");
+    ERR_FAIL_COND_V_MSG(this->generation_phase != PHASE_IDLE, -1.0f, "NEATAgent Dataset Error: Cannot evaluate while a generation step is in progress");
+    ERR_FAIL_COND_V_MSG(loss_str != "mse" && loss_str != "cross_entropy" && loss_str != "accuracy", -1.0f, "NEATAgent Dataset Error: Loss must be \"mse\", \"cross_entropy\", or \"accuracy\"");
+    ERR_FAIL_COND_V_MSG(batch_size < 0, -1.0f, "NEATAgent Dataset Error: Batch size must be 0 (every row) or greater");
+
+    Dataset::Loss loss_type = Dataset::LOSS_MSE;
+    if (loss_str == "cross_entropy") loss_type = Dataset::LOSS_CROSS_ENTROPY;
+    else if (loss_str == "accuracy") loss_type = Dataset::LOSS_ACCURACY;
+
+    return evaluate_rows(this->dataset, loss_type, batch_size, 0);
+}
+
+float NEATAgent::evaluate_rows(const Dataset* data, Dataset::Loss loss_type, int batch_size, int thread_count){
+    //Rows are copied into a buffer sized from the dataset, so a mismatch would read past it
+    ERR_FAIL_COND_V_MSG(data->input_size != guess_input_size() || data->target_size != guess_output_size(), -1.0f, "NEATAgent Dataset Error: Dataset input and target sizes must match the network inputs and outputs");
+
+    //Every network sees the same mini-batch so their fitness is comparable. Floyd's sampling keeps it O(batch) for huge files
+    std::vector<int> batch;
+    if (batch_size == 0 || batch_size >= data->rows){
+        batch.resize(data->rows);
+        for (int i = 0; i < data->rows; i++) batch[i] = i;
+    }
+    else{
+        NEATRandom batch_rng = network_stream(this->generation_count, -2);
+        std::unordered_set<int> chosen;
+        for (int j = data->rows - batch_size; j < data->rows; j++){
+            int pick = std::uniform_int_distribution<int>(0, j)(batch_rng);
+            if (!chosen.insert(pick).second) chosen.insert(j);
+        }
+        batch.assign(chosen.begin(), chosen.end());
+        std::sort(batch.begin(), batch.end()); //Front to back through the mapping
+    }
+
+    NEAT_TRACE_SCOPE("evaluate_dataset", "inference");
+    int hidden_function = Network::activation_code(this->hidden_activation);
+    int output_function = Network::activation_code(this->output_activation);
+    int input_size = data->input_size;
+    int output_size = guess_output_size();
+
+    //Networks whose compiled paths differ only in weights are evaluated together, one vector lane per network (see
+    //compiled_network::evaluate_lanes). Weight only children and repopulated champions keep their parent's path, so groups are common
+    const int MAX_LANES = 64;
+    std::vector<std::vector<int>> tasks;
+    std::unordered_map<uint64_t, std::vector<int>> open_tasks; //Topology hash -> tasks still taking networks
+    for (int n = 0; n < this->population.size(); n++){
+        Network* network = this->population[n];
+        if (this->fitness_cache_auto_fill && network->fitness_cached) continue;
+
+        int joined = -1;
+        if (!this->substrate_mode){
+            std::vector<int> &candidates = open_tasks[network->topology_hash];
+            for (int t : candidates){
+                if (tasks[t].size() < MAX_LANES && this->population[tasks[t][0]]->same_topology(network)){
+                    joined = t;
+                    break;
+                }
+            }
+            if (joined == -1) candidates.push_back(tasks.size());
+        }
+        if (joined == -1){
+            joined = tasks.size();
+            tasks.emplace_back();
+        }
+        tasks[joined].push_back(n);
+    }
+
+    std::vector<float> losses(this->population.size(), 0.0f);
+    parallel_for(tasks.size(), thread_count, [&](int t) {
+        const std::vector<int> &members = tasks[t];
+        Network* network = this->population[members[0]];
+        NEAT_TRACE_SCOPE("evaluate_dataset_network", "inference");
+
+        std::vector<float> row_inputs(input_size + 1, 1.0f); //Last input stays 1.0 for the bias
+        std::vector<float> outputs(output_size);
+
+        if (members.size() > 1){
+            int lanes = members.size();
+            int edge_count = network->compiled_edge_to.size();
+            std::vector<float> lane_weights((size_t)edge_count * lanes);
+            for (int l = 0; l < lanes; l++){
+                const std::vector<float> &weights = this->population[members[l]]->compiled_edge_weight;
+                for (int e = 0; e < edge_count; e++) lane_weights[(size_t)e * lanes + l] = weights[e];
+            }
+            std::vector<float> lane_outputs((size_t)output_size * lanes);
+            std::vector<float> lane_scratch(network->compiled_kind.size() * lanes);
+            std::vector<float> sums(lanes, 0.0f);
+
+            for (int row : batch){
+                std::copy(data->row_inputs(row), data->row_inputs(row) + input_size, row_inputs.begin());
+                compiled_network::evaluate_lanes(network->compiled_kind.size(), network->compiled_kind.data(), network->compiled_io_index.data(), network->compiled_edge_start.data(),
+                                                 network->compiled_edge_to.data(), lane_weights.data(), output_size, hidden_function, output_function, lanes,
+                                                 row_inputs.data(), lane_outputs.data(), lane_scratch.data());
+                for (int l = 0; l < lanes; l++){
+                    for (int o = 0; o < output_size; o++) outputs[o] = lane_outputs[(size_t)o * lanes + l];
+                    sums[l] += Dataset::row_loss(loss_type, outputs.data(), data->row_targets(row), output_size);
+                }
+            }
+            for (int l = 0; l < lanes; l++) losses[members[l]] = sums[l] / batch.size();
+            return;
+        }
+
+        float sum = 0.0f;
+        if (this->substrate_mode){
+            //Each task realizes its own network's substrate, so building them is spread over the threads too
+            const SubstrateNetwork* realized = realize_substrate(network);
+            std::vector<float> substrate_scratch;
+            for (int row : batch){
+                realized->evaluate(*this->substrate, data->row_inputs(row), outputs.data(), substrate_scratch);
+                sum += Dataset::row_loss(loss_type, outputs.data(), data->row_targets(row), output_size);
+            }
+            losses[members[0]] = sum / batch.size();
+            return;
+        }
+        std::vector<float> scratch(network->compiled_kind.size());
+        for (int row : batch){
+            std::copy(data->row_inputs(row), data->row_inputs(row) + input_size, row_inputs.begin());
+            compiled_network::evaluate(network->compiled_kind.size(), network->compiled_kind.data(), network->compiled_io_index.data(), network->compiled_edge_start.data(),
+                                       network->compiled_edge_to.data(), network->compiled_edge_weight.data(), output_size, hidden_function, output_function,
+                                       row_inputs.data(), outputs.data(), scratch.data());
+            sum += Dataset::row_loss(loss_type, outputs.data(), data->row_targets(row), output_size);
+        }
+        losses[members[0]] = sum / batch.size();
+    });
+
+    //Losses become a fitness in (0, 1] that grows as the loss shrinks, accuracy is used as is
+    float best = (loss_type == Dataset::LOSS_ACCURACY) ? 0.0f : INFINITY;
+    for (int n = 0; n < this->population.size(); n++){
+        Network* network = this->population[n];
+        if (this->fitness_cache_auto_fill && network->fitness_cached) continue;
+
+        if (loss_type == Dataset::LOSS_ACCURACY){
+            network->fitness = std::max(losses[n], 0.001f);
+            best = std::max(best, losses[n]);
+        }
+        else{
+            network->fitness = 1.0f / (1.0f + losses[n]);
+            best = std::min(best, losses[n]);
+        }
+    }
+    return best;
+}
+
+void NEATAgent::enable_telemetry(int capacity){ //NOTE: Replaces any existing buffer, so dont call while another thread is draining
+    ERR_FAIL_COND_MSG(capacity < 1, "NEATAgent Telemetry Error: Capacity must be greater than 0");
+    delete this->telemetry;
+    this->telemetry = new TelemetryRing(capacity);
+}
+
+void NEATAgent::disable_telemetry(){ //NOTE: Same as enable_telemetry, no other thread may be draining
+    delete this->telemetry;
+    this->telemetry = nullptr;
+}
+
+Dictionary NEATAgent::drain_telemetry(int max_records){ //NOTE: Safe to call from any thread while the agent evolves. Each record is returned once
+    Dictionary columns;
+    ERR_FAIL_COND_V_MSG(this->telemetry == nullptr, columns, "NEATAgent Telemetry Error: Telemetry is not enabled");
+    ERR_FAIL_COND_V_MSG(max_records < 0, columns, "NEATAgent Telemetry Error: Max records must be 0 (every record) or greater");
+
+    std::vector<TelemetryRecord> records;
+    this->telemetry->drain(records, max_records);
+
+    PackedInt64Array generation;
+    PackedInt32Array population_size, species_count, species_size_min, species_size_max, active_connections_max, hidden_neurons_max;
+    PackedFloat32Array compatibility_threshold, champion_fitness, fitness_min, fitness_p25, fitness_median, fitness_p75, fitness_max, fitness_mean, fitness_stddev;
+    PackedFloat32Array species_size_mean, active_connections_mean, hidden_neurons_mean;
+    for (const TelemetryRecord &r : records){
+        generation.push_back(r.generation);
+        population_size.push_back(r.population_size);
+        species_count.push_back(r.species_count);
+        compatibility_threshold.push_back(r.compatibility_threshold);
+        champion_fitness.push_back(r.champion_fitness);
+        fitness_min.push_back(r.fitness_min);
+        fitness_p25.push_back(r.fitness_p25);
+        fitness_median.push_back(r.fitness_median);
+        fitness_p75.push_back(r.fitness_p75);
+        fitness_max.push_back(r.fitness_max);
+        fitness_mean.push_back(r.fitness_mean);
+        fitness_stddev.push_back(r.fitness_stddev);
+        species_size_min.push_back(r.species_size_min);
+        species_size_max.push_back(r.species_size_max);
+        species_size_mean.push_back(r.species_size_mean);
+        active_connections_mean.push_back(r.active_connections_mean);
+        active_connections_max.push_back(r.active_connections_max);
+        hidden_neurons_mean.push_back(r.hidden_neurons_mean);
+        hidden_neurons_max.push_back(r.hidden_neurons_max);
+    }
+
+    columns["generation"] = generation;
+    columns["population_size"] = population_size;
+    columns["species_count"] = species_count;
+    columns["compatibility_threshold"] = compatibility_threshold;
+    columns["champion_fitness"] = champion_fitness;
+    columns["fitness_min"] = fitness_min;
+    columns["fitness_p25"] = fitness_p25;
+    columns["fitness_median"] = fitness_median;
+    columns["fitness_p75"] = fitness_p75;
+    columns["fitness_max"] = fitness_max;
+    columns["fitness_mean"] = fitness_mean;
+    columns["fitness_stddev"] = fitness_stddev;
+    columns["species_size_min"] = species_size_min;
+    columns["species_size_max"] = species_size_max;
+    columns["species_size_mean"] = species_size_mean;
+    columns["active_connections_mean"] = active_connections_mean;
+    columns["active_connections_max"] = active_connections_max;
+    columns["hidden_neurons_mean"] = hidden_neurons_mean;
+    columns["hidden_neurons_max"] = hidden_neurons_max;
+    columns["dropped"] = (int64_t)this->telemetry->get_dropped();
+    return columns;
+}
+
+int NEATAgent::get_telemetry_available(){
+    return this->telemetry != nullptr ? this->telemetry->available() : 0;
+}
+
+void NEATAgent::fill_population_telemetry(TelemetryRecord &record){
+    record.generation = this->generation_count;
+    record.population_size = this->population.size();
+    record.champion_fitness = this->global_highest_fitness;
+
+    //Complexity, counted without get_active_connection_count since that copies every gene
+    std::vector<float> &fitness = this->telemetry_scratch;
+    fitness.clear();
+    double fitness_sum = 0.0, fitness_squares = 0.0, connection_sum = 0.0, hidden_sum = 0.0;
+    record.active_connections_max = 0;
+    record.hidden_neurons_max = 0;
+    for (Network* n : this->population){
+        int active = n->count_enabled_genes();
+        int hidden = (int)n->get_depth_data().size() - n->inputs - n->outputs;
+
+        connection_sum += active;
+        hidden_sum += hidden;
+        record.active_connections_max = std::max(record.active_connections_max, active);
+        record.hidden_neurons_max = std::max(record.hidden_neurons_max, hidden);
+
+        fitness.push_back(n->fitness);
+        fitness_sum += n->fitness;
+        fitness_squares += (double)n->fitness * n->fitness;
+    }
+
+    int count = fitness.size();
+    if (count == 0) return;
+    record.active_connections_mean = connection_sum / count;
+    record.hidden_neurons_mean = hidden_sum / count;
+    record.fitness_mean = fitness_sum / count;
+    record.fitness_stddev = std::sqrt(std::max(0.0, fitness_squares / count - (fitness_sum / count) * (fitness_sum / count)));
+
+    //Quartiles by selection, each nth_element only works on the part left of the previous one
+    auto quantile = [&fitness, count](float q, int end) {
+        int k = std::min(count - 1, (int)(q * (count - 1) + 0.5f));
+        std::nth_element(fitness.begin(), fitness.begin() + k, fitness.begin() + end);
+        return k;
+    };
+    record.fitness_max = *std::max_element(fitness.begin(), fitness.end());
+    int k75 = quantile(0.75f, count);
+    record.fitness_p75 = fitness[k75];
+    int k50 = quantile(0.5f, k75 + 1);
+    record.fitness_median = fitness[k50];
+    int k25 = quantile(0.25f, k50 + 1);
+    record.fitness_p25 = fitness[k25];
+    record.fitness_min = *std::min_element(fitness.begin(), fitness.begin() + k25 + 1);
+}
+
+void NEATAgent::fill_species_telemetry(TelemetryRecord &record){
+    int species_count = 0, size_min = INT_MAX, size_max = 0, size_sum = 0;
+    auto add_species = [&](const std::vector<Species*> &list) {
+        for (Species* s : list){
+            if (s->member_count == 0) continue;
+            species_count++;
+            size_sum += s->member_count;
+            size_min = std::min(size_min, s->member_count);
+            size_max = std::max(size_max, s->member_count);
+        }
+    };
+    add_species(this->species);
+    for (NEATAgent* island : this->islands) add_species(island->species);
+
+    //Islands each tune their own threshold, report the mean
+    record.compatibility_threshold = this->compatibility_threshold;
+    if (!this->islands.empty()){
+        float threshold_sum = 0.0f;
+        for (NEATAgent* island : this->islands) threshold_sum += island->compatibility_threshold;
+        record.compatibility_threshold = threshold_sum / this->islands.size();
+    }
+
+    record.species_count = species_count;
+    record.species_size_min = species_count > 0 ? size_min : 0;
+    record.species_size_max = size_max;
+    record.species_size_mean = species_count > 0 ? (float)size_sum / species_count : 0.0f;
+}
+
+bool NEATAgent::start_trace(godot::String path){ //NOTE: Tracing is process wide, it covers every agent until stop_trace. Starting again replaces the file
+    std::string path_str = ProjectSettings::get_singleton()->globalize_path(path).utf8().get_data();
+    std::string error;
+    bool started = trace::start(path_str, error);
+    ERR_FAIL_COND_V_MSG(!started, false, ("NEATAgent Trace Error: " + error).c_str());
+    return true;
+}
+
+void NEATAgent::stop_trace(){
+    trace::stop();
+}
+
+bool NEATAgent::start_champion_log(godot::String path){ //NOTE: Appends to an existing log for the same inputs, outputs and activations. Only champions found after this call are logged. Read it with ChampionLogReader
+    ERR_FAIL_COND_V_MSG(this->population.empty(), false, "NEATAgent Champion Log Error: Initialize or import a population before starting a champion log");
+    std::string path_str = ProjectSettings::get_singleton()->globalize_path(path).utf8().get_data();
+
+    if (this->champion_log == nullptr) this->champion_log = new ChampionLogWriter();
+    champion_log::Header header = {(uint32_t)this->inputs, (uint32_t)this->outputs, (uint32_t)Network::activation_code(this->hidden_activation), (uint32_t)Network::activation_code(this->output_activation)};
+    bool opened = this->champion_log->open(path_str, header);
+    ERR_FAIL_COND_V_MSG(!opened, false, ("NEATAgent Champion Log Error: " + this->champion_log->last_error).c_str());
+    this->champion_log_pending = false;
+    return true;
+}
+
+void NEATAgent::stop_champion_log(){ //NOTE: Waits for queued champions to be written
+    if (this->champion_log != nullptr) this->champion_log->close();
+}
+
+void NEATAgent::log_champion(){
+    bool pending = this->champion_log_pending;
+    this->champion_log_pending = false;
+    if (!pending || this->champion_log == nullptr || this->global_champion == nullptr) return;
+
+    //Encoding is cheap next to a generation, the writer thread does the file work
+    std::vector<champion_log::Connection> connections;
+    prune_network(this->global_champion, connections);
+    this->champion_log->append(this->generation_count, this->global_highest_fitness, connections);
+}
+
+void NEATAgent::set_compact_genomes(bool enabled){ //NOTE: Trades some CPU (genomes are rebuilt whenever they are read) for memory in very large populations
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Set Error: Cannot change genome storage while a generation step is in progress");
+
+    this->compact_genomes = enabled;
+    sync_island_settings();
+    for (Network* n : this->population){
+        if (enabled && !n->genome_compacted) n->compact_genome(nullptr, nullptr);
+        else if (!enabled && n->genome_compacted) n->expand_genome();
+    }
+}
+
+void NEATAgent::set_species_index(bool enabled, int bands, int rows){ //NOTE: Approximate, a network can miss a compatible species whose innovations look too different and start a new one
+    ERR_FAIL_COND_MSG(bands < 1 || rows < 1, "NEATAgent Set Error: Bands and rows must be greater than 0");
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Set Error: Cannot change the species index while a generation step is in progress");
+
+    this->species_index_enabled = enabled;
+    this->species_index_bands = bands;
+    this->species_index_rows = rows;
+    sync_island_settings();
+}
+
+void NEATAgent::set_parent_selection(godot::String mode, int tournament_size){ //NOTE: Modes are "uniform", "tournament", "rank" and "proportional" (to adjusted fitness). Applies within a species, offspring counts per species are unchanged
+    ERR_FAIL_COND_MSG(tournament_size < 1, "NEATAgent Set Error: Tournament size must be greater than 0");
+    ERR_FAIL_COND_MSG(this->generation_phase != PHASE_IDLE, "NEATAgent Set Error: Cannot change parent selection while a generation step is in progress");
+
+    if (mode == "uniform") this->selection_mode = SELECTION_UNIFORM;
+    else if (mode == "tournament") this->selection_mode = SELECTION_TOURNAMENT;
+    else if (mode == "rank") this->selection_mode = SELECTION_RANK;
+    else if (mode == "proportional") this->selection_mode = SELECTION_PROPORTIONAL;
+    else ERR_FAIL_MSG("NEATAgent Set Error: Selection mode must be uniform, tournament, rank or proportional");
+
+    this->tournament_size = tournament_size;
+    sync_island_settings();
+}
+
+void NEATAgent::rebuild_species_index(){
+    if (this->species_index == nullptr) this->species_index = new SpeciesIndex();
+    this->species_index->configure(this->species_index_bands, this->species_index_rows);
+
+    std::vector<const std::vector<std::vector<float>>*> representatives;
+    for (Species* s : this->species) representatives.push_back(&s->representative_genome);
+    this->species_index->ignore_shared_innovations(representatives);
+
+    std::vector<uint64_t> representative_signature;
+    for (int i = 0; i < this->species.size(); i++){
+        this->species_index->signature(this->species[i]->representative_genome, representative_signature);
+        this->species_index->insert(i, representative_signature);
+    }
+}
+
+Species* NEATAgent::find_compatible_species(Network* network){
+    //First fit over every species, or over the index's candidates in the same order
+    if (!this->species_index_enabled){
+        for (Species* s : this->species) {
+            if (s->evaluate_compatibility(network) < this->compatibility_threshold) return s;
+        }
+        return nullptr;
+    }
+
+    //The signature stays in signature_scratch so a new species can be indexed with it
+    this->species_index->signature(network->get_connection_data(), this->signature_scratch);
+    this->species_index->candidates(this->signature_scratch, this->candidate_scratch);
+    for (int i : this->candidate_scratch) {
+        if (this->species[i]->evaluate_compatibility(network) < this->compatibility_threshold) return this->species[i];
+    }
+    return nullptr;
+}
+
+bool NEATAgent::set_substrate(PackedVector2Array input_positions, PackedVector2Array output_positions, Array hidden_layers, String hidden_activation, String output_activation, float weight_threshold, float max_weight){ //NOTE: Guesses and datasets then use the substrate's inputs and outputs. Workers, shared memory and extracted champions still see the CPPN
+    ERR_FAIL_COND_V_MSG(input_positions.size() < 1 || output_positions.size() < 1, false, "NEATAgent Substrate Error: Substrate needs at least one input and one output position");
+    ERR_FAIL_COND_V_MSG(weight_threshold < 0.0 || weight_threshold >= 1.0, false, "NEATAgent Substrate Error: Weight threshold must be in range 0.0 to less than 1.0");
+    ERR_FAIL_COND_V_MSG(max_weight <= 0.0, false, "NEATAgent Substrate Error: Max weight must be greater than 0.0");
+    int hidden_function = Network::activation_code(hidden_activation.utf8().get_data());
+    int output_function = Network::activation_code(output_activation.utf8().get_data());
+    ERR_FAIL_COND_V_MSG(hidden_function == -1 || output_function == -1, false, "NEATAgent Substrate Error: Activation functions must be \"relu\", \"linear\", \"sigmoid\", or \"tanh\"");
+    for (int i = 0; i < hidden_layers.size(); i++){
+        ERR_FAIL_COND_V_MSG(hidden_layers[i].get_type() != Variant::PACKED_VECTOR2_ARRAY, false, ("NEATAgent Substrate Error: Hidden layer " + std::to_string(i) + " is not a PackedVector2Array").c_str());
+        PackedVector2Array layer = hidden_layers[i];
+        ERR_FAIL_COND_V_MSG(layer.size() < 1, false, ("NEATAgent Substrate Error: Hidden layer " + std::to_string(i) + " is empty").c_str());
+    }
+
+    auto add_layer = [](Substrate* target, const PackedVector2Array &layer) {
+        std::vector<float> positions(layer.size() * 2);
+        for (int i = 0; i < layer.size(); i++){
+            positions[2 * i] = layer[i].x;
+            positions[2 * i + 1] = layer[i].y;
+        }
+        target->positions.push_back(positions);
+    };
+
+    if (this->substrate == nullptr) this->substrate = new Substrate();
+    this->substrate->positions.clear();
+    add_layer(this->substrate, input_positions);
+    for (int i = 0; i < hidden_layers.size(); i++) add_layer(this->substrate, hidden_layers[i]);
+    add_layer(this->substrate, output_positions);
+    this->substrate->hidden_function = hidden_function;
+    this->substrate->output_function = output_function;
+    this->substrate->weight_threshold = weight_threshold;
+    this->substrate->max_weight = max_weight;
+
+    //Networks rebuild their substrate the next time they are used
+    this->substrate_version++;
+    return true;
+}
+
+void NEATAgent::initialize_substrate_population(int population_size, String cppn_activation, int species_count, float initial_enabled_percent){ //NOTE: Call set_substrate first. Same as initialize_population with CPPN inputs (x1, y1, x2, y2) and outputs (weight, bias)
+    ERR_FAIL_COND_MSG(this->substrate == nullptr, "NEATAgent Substrate Error: Call set_substrate before initializing a substrate population");
+
+    //CPPN outputs are read as values in [-1, 1], so the output activation is always tanh
+    initialize_population(Substrate::CPPN_INPUTS, Substrate::CPPN_OUTPUTS, population_size, cppn_activation, "tanh", species_count, initial_enabled_percent);
+    bool initialized = this->inputs == Substrate::CPPN_INPUTS + 1 && this->outputs == Substrate::CPPN_OUTPUTS && this->population.size() == population_size;
+    this->substrate_mode = initialized;
+}
+
+int NEATAgent::get_substrate_weight_count(){ //NOTE: Connections in each realized substrate network, the dense matrices include the ones below the threshold
+    return this->substrate != nullptr ? (int)this->substrate->weight_count() : 0;
+}
+
+const SubstrateNetwork* NEATAgent::realize_substrate(Network* network){
+    //Weights never change once a network is built, it only needs building again if the substrate changes
+    if (network->substrate_network == nullptr || network->substrate_version != this->substrate_version){
+        if (network->substrate_network == nullptr) network->substrate_network.reset(new SubstrateNetwork());
+        network->substrate_network->build(*this->substrate, network);
+        network->substrate_version = this->substrate_version;
+    }
+    return network->substrate_network.get();
+}
+
+int NEATAgent::guess_input_size(){
+    return this->substrate_mode ? this->substrate->input_count() : this->inputs - 1;
+}
+
+int NEATAgent::guess_output_size(){
+    return this->substrate_mode ? this->substrate->output_count() : this->outputs;
+}
+
+bool NEATAgent::start_racing(int max_episodes, int min_episodes, String mode, float keep_fraction, float confidence){ //NOTE: Run one episode per entry of get_racing_batch and report each with add_episode_fitness until the batch comes back empty
+    ERR_FAIL_COND_V_MSG(this->population.empty(), false, "NEATAgent Racing Error: Initialize or import a population before racing");
+    ERR_FAIL_COND_V_MSG(this->generation_phase != PHASE_IDLE, false, "NEATAgent Racing Error: Cannot start a race while a generation step is in progress");
+    ERR_FAIL_COND_V_MSG(min_episodes < 1 || max_episodes < min_episodes, false, "NEATAgent Racing Error: Episodes must satisfy 1 <= min_episodes <= max_episodes");
+    ERR_FAIL_COND_V_MSG(keep_fraction <= 0.0 || keep_fraction >= 1.0, false, "NEATAgent Racing Error: Keep fraction must be in range 0.0 to 1.0 exclusive");
+    ERR_FAIL_COND_V_MSG(confidence <= 0.0, false, "NEATAgent Racing Error: Confidence must be greater than 0.0");
+
+    EvaluationRace::Mode race_mode;
+    if (mode == "halving") race_mode = EvaluationRace::MODE_HALVING;
+    else if (mode == "racing") race_mode = EvaluationRace::MODE_RACING;
+    else ERR_FAIL_V_MSG(false, "NEATAgent Racing Error: Mode must be halving or racing");
+
+    if (this->race == nullptr) this->race = new EvaluationRace();
+    this->race->mode = race_mode;
+    this->race->min_episodes = min_episodes;
+    this->race->max_episodes = max_episodes;
+    this->race->keep_fraction = keep_fraction;
+    this->race->confidence = confidence;
+    this->race->generation = this->generation_count;
+    this->race->start(this->population.size());
+    return true;
+}
+
+PackedInt32Array NEATAgent::get_racing_batch(){ //NOTE: A network can appear more than once, once per episode it is owed. Dropped networks keep the mean of the episodes they ran
+    PackedInt32Array batch;
+    if (this->race == nullptr || !this->race->active) return batch;
+
+    this->race->next_batch(this->race_batch_scratch);
+    if (!this->race->active){
+        finish_racing();
+        return batch;
+    }
+    batch.resize(this->race_batch_scratch.size());
+    for (int i = 0; i < this->race_batch_scratch.size(); i++) batch[i] = this->race_batch_scratch[i];
+    return batch;
+}
+
+void NEATAgent::add_episode_fitness(int index, float fitness){
+    ERR_FAIL_COND_MSG(this->race == nullptr || !this->race->active, "NEATAgent Racing Error: No race in progress, call start_racing first");
+    ERR_FAIL_COND_MSG(index < 0 || index >= this->population.size(), "NEATAgent Racing Error: Index must be in range 0 to population_size-1");
+    ERR_FAIL_COND_MSG(fitness <= 0.0001, "NEATAgent Racing Error: Fitness must be greater than 0.0001");
+    this->race->add_episode(index, fitness);
+}
+
+bool NEATAgent::is_racing(){
+    return this->race != nullptr && this->race->active;
+}
+
+int NEATAgent::get_racing_episode_count(){ //NOTE: Episodes reported in the current or last race, compare with population_size * max_episodes
+    return this->race != nullptr ? this->race->episodes_run : 0;
+}
+
+int NEATAgent::get_network_episode_count(int index){ //NOTE: Episodes in the current or last race. 0 once a new generation has replaced the networks it raced
+    ERR_FAIL_COND_V_MSG(index < 0 || index >= this->population.size(), -1, "NEATAgent Racing Error: Index must be in range 0 to population_size-1");
+    if (this->race == nullptr || this->race->generation != this->generation_count || index >= this->race->entry_count()) return 0;
+    return this->race->episodes(index);
+}
+
+void NEATAgent::finish_racing(){
+    this->race->active = false;
+    for (int i = 0; i < this->population.size() && i < this->race->entry_count(); i++){
+        if (this->race->episodes(i) > 0) this->population[i]->fitness = std::max(this->race->estimate(i), 0.0001f);
+    }
+}
+
+bool NEATAgent::start_replay_log(godot::String path){ //NOTE: Call before the first generation, right after initialize_population or import_template (not initialize_substrate_population). Any logged generation can then be rebuilt with replay_generation
+    ERR_FAIL_COND_V_MSG(this->population.empty(), false, "NEATAgent Replay Error: Initialize or import a population before starting a replay log");
+    ERR_FAIL_COND_V_MSG(this->generation_count != 0 || this->generation_phase != PHASE_IDLE, false, "NEATAgent Replay Error: A replay log must start before the first generation");
+    ERR_FAIL_COND_V_MSG(!this->islands.empty() || this->novelty_enabled, false, "NEATAgent Replay Error: Island mode and novelty search cannot be replayed");
+    ERR_FAIL_COND_V_MSG(this->substrate_mode, false, "NEATAgent Replay Error: Substrate mode cannot be replayed, the log does not keep the substrate");
+    std::string path_str = ProjectSettings::get_singleton()->globalize_path(path).utf8().get_data();
+
+    if (this->replay_log == nullptr) this->replay_log = new ReplayLogWriter();
+    bool opened = this->replay_log->open(path_str, this->genesis);
+    ERR_FAIL_COND_V_MSG(!opened, false, ("NEATAgent Replay Error: " + this->replay_log->last_error).c_str());
+    this->replay_events = 0;
+    this->replay_record_pending = false;
+    return true;
+}
+
+void NEATAgent::stop_replay_log(){ //NOTE: A generation still being stepped is left out
+    if (this->replay_log != nullptr) this->replay_log->close();
+    this->replay_record_pending = false;
+}
+
+bool NEATAgent::replay_generation(godot::String path, int generation){ //NOTE: Replaces the population with the one of that generation, given the fitness it had in the logged run. Also sets the seed, like set_seed
+    ERR_FAIL_COND_V_MSG(this->generation_phase != PHASE_IDLE, false, "NEATAgent Replay Error: Cannot replay while a generation step is in progress");
+    ERR_FAIL_COND_V_MSG(this->novelty_enabled, false, "NEATAgent Replay Error: Disable novelty search before replaying");
+    std::string path_str = ProjectSettings::get_singleton()->globalize_path(path).utf8().get_data();
+
+    ReplayLogFile log;
+    ERR_FAIL_COND_V_MSG(!log.read_file(path_str), false, ("NEATAgent Replay Error: " + log.last_error).c_str());
+    ERR_FAIL_COND_V_MSG(generation < 0 || generation > log.record_count(), false, ("NEATAgent Replay Error: Generation must be in range 0 to " + std::to_string(log.record_count())).c_str());
+    replay_log::Genesis genesis = log.genesis;
+    ERR_FAIL_COND_V_MSG(genesis.hidden_function > 3 || genesis.output_function > 3, false, "NEATAgent Replay Error: Replay log has an unknown activation function");
+
+    //The first population is built again from the same seed, then every logged generation is bred with the fitness it was given
+    static const char* ACTIVATION_NAMES[] = {"relu", "linear", "sigmoid", "tanh"};
+    stop_replay_log();
+    set_seed((int64_t)genesis.seed);
+    if (genesis.kind == replay_log::GENESIS_TEMPLATE){
+        Array network_data;
+        network_data.append((int)genesis.inputs);
+        network_data.append((int)genesis.outputs);
+        network_data.append((int)genesis.hidden_function);
+        network_data.append((int)genesis.output_function);
+        for (const champion_log::Connection &connection : genesis.template_connections){
+            Array connection_array;
+            connection_array.append((int)connection.from);
+            connection_array.append((int)connection.to);
+            connection_array.append(connection.weight);
+            network_data.append(connection_array);
+        }
+        import_template(network_data, genesis.population_size, genesis.species_count);
+    }
+    else{
+        initialize_population(genesis.inputs, genesis.outputs, genesis.population_size, ACTIVATION_NAMES[genesis.hidden_function], ACTIVATION_NAMES[genesis.output_function], genesis.species_count, genesis.initial_enabled_percent);
+    }
+    ERR_FAIL_COND_V_MSG(this->population.size() != genesis.population_size, false, "NEATAgent Replay Error: Could not rebuild the first population");
+
+    replay_log::Generation record;
+    for (int r = 0; r < generation; r++){
+        log.read_record(r, record);
+        ERR_FAIL_COND_V_MSG(record.generation != r || record.fitness.size() != this->population.size(), false, ("NEATAgent Replay Error: Record " + std::to_string(r) + " does not follow the population").c_str());
+        apply_replay_record(record);
+        next_generation();
+
+        bool same = record.innovation_counter == (uint32_t)this->registry->innovation_counter && record.neuron_counter == (uint32_t)this->registry->neuron_counter && record.population_hash == get_population_hash();
+        ERR_FAIL_COND_V_MSG(!same, false, ("NEATAgent Replay Error: Replay diverged from the log at generation " + std::to_string(r)).c_str());
+    }
+    if (generation < log.record_count()){
+        log.read_record(generation, record);
+        if (record.fitness.size() == this->population.size()) apply_replay_record(record);
+    }
+    return true;
+}
+
+void NEATAgent::set_genesis(uint32_t kind, int genesis_inputs, float initial_enabled_percent){
+    this->genesis = replay_log::Genesis();
+    this->genesis.seed = this->seed;
+    this->genesis.kind = kind;
+    this->genesis.inputs = genesis_inputs;
+    this->genesis.outputs = this->outputs;
+    this->genesis.population_size = this->population_size;
+    this->genesis.species_count = this->desired_species_count;
+    this->genesis.hidden_function = Network::activation_code(this->hidden_activation);
+    this->genesis.output_function = Network::activation_code(this->output_activation);
+    this->genesis.initial_enabled_percent = initial_enabled_percent;
+}
+
+void NEATAgent::begin_replay_record(){
+    replay_log::Generation &record = this->replay_record;
+    record.generation = this->generation_count;
+    record.flags = this->replay_events;
+    if (this->structural_growth_blocked) record.flags |= replay_log::FLAG_GROWTH_BLOCKED;
+    if (this->species_index_enabled) record.flags |= replay_log::FLAG_SPECIES_INDEX;
+    this->replay_events = 0;
+
+    record.seed = this->seed;
+    record.settings = {this->rate_weight_mutate, this->rate_connection_mutate, this->rate_enable_mutate, this->rate_node_mutate, this->size_cap, this->stagnation_limit,
+                       (int32_t)this->selection_mode, this->tournament_size, this->species_index_bands, this->species_index_rows};
+    record.fitness.resize(this->population.size());
+    for (int i = 0; i < this->population.size(); i++) record.fitness[i] = this->population[i]->fitness;
+    this->replay_record_pending = true;
+}
+
+void NEATAgent::finish_replay_record(){
+    this->replay_record_pending = false;
+    this->replay_record.innovation_counter = this->registry->innovation_counter;
+    this->replay_record.neuron_counter = this->registry->neuron_counter;
+    this->replay_record.population_hash = get_population_hash();
+    this->replay_log->append(this->replay_record);
+}
+
+void NEATAgent::apply_replay_record(const replay_log::Generation &record){
+    //Events first, in the order they can happen between two generations
+    if (record.flags & replay_log::FLAG_CHAMPION_RESET) force_champion_reset();
+    if (record.flags & replay_log::FLAG_INNOVATIONS_COMPACTED) compact_innovation_table();
+    this->structural_growth_blocked = (record.flags & replay_log::FLAG_GROWTH_BLOCKED) != 0;
+    this->species_index_enabled = (record.flags & replay_log::FLAG_SPECIES_INDEX) != 0;
+
+    const replay_log::Settings &settings = record.settings;
+    this->seed = record.seed;
+    this->rate_weight_mutate = settings.rate_weight_mutate;
+    this->rate_connection_mutate = settings.rate_connection_mutate;
+    this->rate_enable_mutate = settings.rate_enable_mutate;
+    this->rate_node_mutate = settings.rate_node_mutate;
+    this->size_cap = settings.size_cap;
+    this->stagnation_limit = settings.stagnation_limit;
+    this->selection_mode = (SelectionMode)settings.selection_mode;
+    this->tournament_size = settings.tournament_size;
+    this->species_index_bands = settings.species_index_bands;
+    this->species_index_rows = settings.species_index_rows;
+
+    for (int i = 0; i < this->population.size(); i++) this->population[i]->fitness = record.fitness[i];
+}
+
+uint64_t NEATAgent::get_population_hash(){
+    //Order matters, the same genomes at different indices are a different population
+    uint64_t hash = 1469598103934665603ULL;
+    for (Network* n : this->population) hash = (hash ^ n->genome_hash) * 1099511628211ULL;
+    return hash;
+}
+
+NEATAgent::NEATAgent(){
+    this->registry = std::make_shared<InnovationRegistry>();
+}
+
+NEATAgent::~NEATAgent(){
+    stop_evaluation_workers();
+    close_population_shared_memory();
+
+    //Islands hand their networks back first so every network is deleted exactly once
+    clear_islands();
+    for (Network* n : this->population) delete n;
+    for (Network* n : this->next_population) delete n;
+    for (Species* s : this->species) delete s;
+    delete this->global_champion;
+
+    delete this->novelty_archive;
+    delete this->dataset;
+    delete this->telemetry;
+    delete this->species_index;
+    delete this->champion_log;
+    delete this->substrate;
+    delete this->race;
+    delete this->replay_log;
+}
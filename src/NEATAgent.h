@@ -5,16 +5,38 @@
 #include <random>
 #include <map>
 #include <unordered_set>
+#include <unordered_map>
 #include <string>
+#include "Random.h"
+#include "InnovationRegistry.h"
+#include "Telemetry.h"
+#include "Dataset.h"
+#include "ReplayLog.h"
+#include <memory>
 #include <godot_cpp/classes/ref_counted.hpp>
 
 class Network;
 class Species;
+struct EvaluationWorkerPool;
+struct SharedPopulationWriter;
+struct BehaviorArchive;
+struct SpeciesIndex;
+struct ChampionLogWriter;
+struct ReplayLogWriter;
+struct Substrate;
+struct EvaluationRace;
+struct SubstrateNetwork;
+namespace champion_log {
+    struct Connection;
+}
 
 namespace godot {
 
+    class NEATModel;
+
     class NEATAgent : public RefCounted {
         GDCLASS(NEATAgent, RefCounted);
+        friend class NEATSweep;
     protected:
         static void _bind_methods();
     private:
@@ -35,7 +57,133 @@ namespace godot {
         float last_best_fitness;
         int stagnation_limit = INT_MAX;
 
-        std::vector<Network*> reproduce(Species* s);
+        //Resumable state of the generation currently being built (see step_generation)
+        enum GenerationPhase { PHASE_IDLE, PHASE_REPOPULATE, PHASE_NOVELTY, PHASE_SPECIATE, PHASE_ADJUST, PHASE_CULL, PHASE_ALLOCATE, PHASE_REPRODUCE, PHASE_FILL, PHASE_SWAP };
+        GenerationPhase generation_phase = PHASE_IDLE;
+        int phase_cursor = 0;
+        int species_child_cursor = 0;
+        Network* best_performer = nullptr;
+        float global_adjusted_sum = 0.0;
+        std::vector<Network*> next_population;
+
+        void begin_generation();
+        void run_generation_unit();
+        float get_generation_progress();
+        Network* reproduce_child(Species* s, bool elite);
+
+        //Parent selection within a species (see set_parent_selection)
+        enum SelectionMode { SELECTION_UNIFORM, SELECTION_TOURNAMENT, SELECTION_RANK, SELECTION_PROPORTIONAL };
+        SelectionMode selection_mode = SELECTION_UNIFORM;
+        int tournament_size = 3;
+        std::vector<float> selection_weights;
+        std::vector<Species*> fill_species; //Species with survivors, the only ones PHASE_FILL draws from
+        void build_parent_table(Species* s);
+        Network* select_parent(Species* s);
+
+        uint64_t seed = 0;
+        bool has_fixed_seed = false;
+        void reset_rng();
+        NEATRandom network_stream(int64_t generation, int64_t index);
+
+        //Island mode (see set_island_mode). Islands own their networks, population only points at them
+        std::vector<NEATAgent*> islands;
+        int migration_interval = 10;
+        int migration_size = 2;
+        std::string migration_topology = "ring";
+        void island_generation();
+        void migrate_between_islands();
+        void gather_island_population();
+        void sync_island_settings();
+        void clear_islands();
+        void reset_run(); //Frees the population, species and champion and resets run state for a new population
+
+        EvaluationWorkerPool* worker_pool = nullptr;
+        SharedPopulationWriter* shared_population = nullptr;
+        void publish_shared_population();
+
+        //Novelty search (see enable_novelty_search)
+        bool novelty_enabled = false;
+        int behavior_dimensions = 0;
+        float novelty_weight = 0.5;
+        int novelty_neighbors = 15;
+        float archive_threshold = 1.0;
+        int max_archive_size = 50000;
+        BehaviorArchive* novelty_archive = nullptr;
+        void compute_novelty();
+
+        //Fitness of recently evaluated genomes keyed by genome hash (see enable_fitness_cache)
+        struct CachedFitness {
+            float fitness;
+            int last_generation;
+        };
+        bool fitness_cache_enabled = false;
+        bool fitness_cache_auto_fill = false;
+        int fitness_cache_max_age = 10;
+        std::unordered_map<uint64_t, CachedFitness> fitness_cache;
+        void record_fitness_cache();
+        void apply_fitness_cache();
+
+        Dataset* dataset = nullptr;
+        float evaluate_rows(const Dataset* data, Dataset::Loss loss_type, int batch_size, int thread_count);
+
+        //MinHash index over species representatives (see set_species_index)
+        bool species_index_enabled = false;
+        int species_index_bands = 16;
+        int species_index_rows = 2;
+        SpeciesIndex* species_index = nullptr;
+        std::vector<uint64_t> signature_scratch;
+        std::vector<int> candidate_scratch;
+        void rebuild_species_index();
+        Species* find_compatible_species(Network* network);
+
+        //History of champions (see start_champion_log). A champion can be replaced many times while speciating, only the last one is logged
+        ChampionLogWriter* champion_log = nullptr;
+        bool champion_log_pending = false;
+        void log_champion();
+        void prune_network(Network* network, std::vector<champion_log::Connection> &connections);
+
+        //HyperNEAT (see set_substrate). The population are CPPNs, guesses and dataset evaluation run the substrate each one realizes
+        Substrate* substrate = nullptr;
+        bool substrate_mode = false;
+        int substrate_version = 0;
+        std::vector<float> substrate_scratch;
+        const SubstrateNetwork* realize_substrate(Network* network);
+        int guess_input_size();
+        int guess_output_size();
+
+        //Episode scheduler (see start_racing), estimates go into fitness when the race ends or the next generation starts
+        EvaluationRace* race = nullptr;
+        std::vector<int> race_batch_scratch;
+        void finish_racing();
+
+        //Generation by generation record of the run (see start_replay_log). How the population was made is kept from
+        //initialize_population or import_template, a record is begun when a generation starts breeding and written once it is done
+        ReplayLogWriter* replay_log = nullptr;
+        replay_log::Genesis genesis;
+        replay_log::Generation replay_record;
+        uint32_t replay_events = 0; //Flags of events since the last record
+        bool replay_record_pending = false;
+        void set_genesis(uint32_t kind, int genesis_inputs, float initial_enabled_percent);
+        void begin_replay_record();
+        void finish_replay_record();
+        void apply_replay_record(const replay_log::Generation &record);
+        uint64_t get_population_hash();
+
+        bool compact_genomes = false;
+        Network* adopt_child(Network* child, Network* parent_a, Network* parent_b);
+
+        //Per generation stats for plotting (see enable_telemetry). The scratch keeps sorting fitness allocation free
+        TelemetryRing* telemetry = nullptr;
+        TelemetryRecord pending_telemetry;
+        std::vector<float> telemetry_scratch;
+        void fill_population_telemetry(TelemetryRecord &record);
+        void fill_species_telemetry(TelemetryRecord &record);
+
+        int64_t memory_budget = 0;
+        void measure_memory(size_t &genomes, size_t &phenotypes, size_t &species_bytes, size_t &innovation_bytes, size_t &archive_bytes, size_t &cache_bytes, size_t &race_bytes);
+        size_t get_total_memory_usage();
+        void enforce_memory_budget();
+        void compact_innovation_table();
         static std::vector<float> packed_to_vector_float(const PackedFloat32Array &array);
         static PackedFloat32Array vector_to_packed_float(const std::vector<float> &vec);
 
@@ -44,7 +192,7 @@ namespace godot {
         std::vector<Network*> population;
         std::vector<Species*> species;
 
-        std::mt19937 rng;
+        NEATRandom rng;
 
         float rate_weight_mutate = 0.8;
         float rate_connection_mutate = 0.1;
@@ -52,28 +200,80 @@ namespace godot {
         float rate_node_mutate = 0.03;
         int size_cap = INT_MAX;
 
-        std::map<std::pair<int, int>, int> innovation_table;
-        int neuron_counter = 0;
+        std::shared_ptr<InnovationRegistry> registry;
+        bool structural_growth_blocked = false;
 
         NEATAgent();
         ~NEATAgent();
 
         void initialize_population(int inputs, int outputs, int population_size = 100, String hidden_activation = "tanh", String output_activation = "tanh", int desired_species_count = 5, float initial_enabled_percent = 0.25);
         void import_template(Array network_data, int population_size, int desired_species_count);
+        void set_seed(int64_t seed);
+        int64_t get_seed();
         void set_mutation_rates(float rate_weight_mutate = 0.8f, float rate_connection_mutate = 0.1f, float rate_enable_mutate = 0.05f, float rate_node_mutate = 0.03);
 
         PackedFloat32Array get_network_guess(int index, PackedFloat32Array inputs);
         PackedFloat32Array get_champion_guess(PackedFloat32Array inputs);
         void set_network_fitness(int index, float fitness);
         void next_generation();
+        float step_generation(int budget_usec);
+        bool is_generation_in_progress();
 
         float get_champion_fitness();
         int get_champion_connection_count();
         void set_stagnation_limit(int limit);
         void set_connection_size_limit(int limit);
         Array extract_champion_data();
+        Ref<NEATModel> extract_champion_model();
         void force_champion_reset();
         bool has_champion();
+        bool start_evaluation_workers(String executable_path, int worker_count = 4, float timeout_seconds = 10.0, int batch_size = 4, PackedStringArray arguments = PackedStringArray());
+        int evaluate_population_with_workers();
+        void stop_evaluation_workers();
+        bool publish_population_shared_memory(String name);
+        int read_shared_fitness();
+        void close_population_shared_memory();
+        void set_island_mode(int island_count, int migration_interval = 10, int migration_size = 2, String topology = "ring");
+        int get_island_count();
+        Dictionary get_memory_usage();
+        void set_memory_budget(int64_t bytes);
+        void enable_novelty_search(int behavior_dimensions, float novelty_weight = 0.5f, int neighbors = 15, float archive_threshold = 1.0f, int max_archive_size = 50000);
+        void disable_novelty_search();
+        void set_network_behavior(int index, PackedFloat32Array behavior);
+        float get_network_novelty(int index);
+        int get_novelty_archive_size();
+        void enable_fitness_cache(bool auto_fill = false, int max_age_generations = 10);
+        void disable_fitness_cache();
+        PackedInt32Array get_cached_network_indices();
+        int64_t get_network_genome_hash(int index);
+        bool set_dataset(PackedFloat32Array inputs, PackedFloat32Array targets);
+        bool load_dataset_file(String path);
+        void clear_dataset();
+        int get_dataset_size();
+        float evaluate_dataset(String loss = "mse", int batch_size = 0);
+        void enable_telemetry(int capacity = 4096);
+        void disable_telemetry();
+        Dictionary drain_telemetry(int max_records = 0);
+        int get_telemetry_available();
+        bool start_trace(String path);
+        void set_compact_genomes(bool enabled);
+        void set_species_index(bool enabled, int bands = 16, int rows = 2);
+        void set_parent_selection(String mode = "uniform", int tournament_size = 3);
+        void stop_trace();
+        bool start_champion_log(String path);
+        void stop_champion_log();
+        bool set_substrate(PackedVector2Array input_positions, PackedVector2Array output_positions, Array hidden_layers = Array(), String hidden_activation = "tanh", String output_activation = "tanh", float weight_threshold = 0.2f, float max_weight = 3.0f);
+        void initialize_substrate_population(int population_size = 150, String cppn_activation = "tanh", int species_count = 8, float initial_enabled_percent = 0.25f);
+        int get_substrate_weight_count();
+        bool start_racing(int max_episodes, int min_episodes = 2, String mode = "halving", float keep_fraction = 0.5f, float confidence = 1.96f);
+        PackedInt32Array get_racing_batch();
+        void add_episode_fitness(int index, float fitness);
+        bool is_racing();
+        int get_racing_episode_count();
+        int get_network_episode_count(int index);
+        bool start_replay_log(String path);
+        void stop_replay_log();
+        bool replay_generation(String path, int generation);
         
     };
 };
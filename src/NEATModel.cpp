@@ -0,0 +1,126 @@
+#include "NEATModel.h"
+#include <cstring>
+#include <godot_cpp/classes/file_access.hpp>
+
+using namespace godot;
+
+void NEATModel::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_network_data", "network_data"), &NEATModel::set_network_data);
+    ClassDB::bind_method(D_METHOD("get_network_data"), &NEATModel::get_network_data);
+    ClassDB::bind_method(D_METHOD("create_agent"), &NEATModel::create_agent);
+    ClassDB::bind_method(D_METHOD("get_input_count"), &NEATModel::get_input_count);
+    ClassDB::bind_method(D_METHOD("get_output_count"), &NEATModel::get_output_count);
+    ClassDB::bind_method(D_METHOD("get_connection_count"), &NEATModel::get_connection_count);
+    ClassDB::bind_static_method("NEATModel", D_METHOD("get_cached_model_count"), &NEATModel::get_cached_model_count);
+
+    //Also lets the model be saved inside text resources and scenes, .neatmodel files skip the Variant round trip
+    ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "network_data"), "set_network_data", "get_network_data");
+}
+
+void NEATModel::set_network_data(Array network_data){ //NOTE: Same layout as NEATAgent.extract_champion_data
+    champion_log::Header header;
+    std::vector<champion_log::Connection> connections;
+    if (!NetworkAgent::parse_network_data(network_data, header, connections)) return;
+    this->model = network_model::acquire(header, connections);
+    emit_changed();
+}
+
+Array NEATModel::get_network_data(){
+    Array network_data;
+    if (this->model == nullptr) return network_data;
+
+    network_data.append((int)this->model->header.inputs);
+    network_data.append((int)this->model->header.outputs);
+    network_data.append((int)this->model->header.hidden_function);
+    network_data.append((int)this->model->header.output_function);
+    for (int i = 0; i < this->model->connection_count(); i++){
+        Array connection_array;
+        connection_array.append(this->model->from[i]);
+        connection_array.append(this->model->to[i]);
+        connection_array.append(this->model->weight[i]);
+        network_data.append(connection_array);
+    }
+    return network_data;
+}
+
+Ref<NetworkAgent> NEATModel::create_agent(){ //NOTE: The agent only allocates its own scratch values
+    ERR_FAIL_COND_V_MSG(this->model == nullptr, Ref<NetworkAgent>(), "NEATModel Agent Error: Model has no network");
+
+    Ref<NetworkAgent> agent;
+    agent.instantiate();
+    agent->set_model(this->model);
+    return agent;
+}
+
+int NEATModel::get_input_count(){ //NOTE: Includes the bias input, guess takes one less
+    return this->model == nullptr ? 0 : (int)this->model->header.inputs;
+}
+
+int NEATModel::get_output_count(){
+    return this->model == nullptr ? 0 : (int)this->model->header.outputs;
+}
+
+int NEATModel::get_connection_count(){
+    return this->model == nullptr ? 0 : this->model->connection_count();
+}
+
+int NEATModel::get_cached_model_count(){ //NOTE: Distinct networks currently loaded by any model or agent
+    return network_model::cached_model_count();
+}
+
+PackedStringArray ResourceFormatLoaderNEATModel::_get_recognized_extensions() const {
+    PackedStringArray extensions;
+    extensions.push_back("neatmodel");
+    return extensions;
+}
+
+bool ResourceFormatLoaderNEATModel::_handles_type(const StringName &type) const {
+    return type == StringName("NEATModel") || type == StringName("Resource");
+}
+
+String ResourceFormatLoaderNEATModel::_get_resource_type(const String &path) const {
+    return path.get_extension().to_lower() == "neatmodel" ? String("NEATModel") : String();
+}
+
+Variant ResourceFormatLoaderNEATModel::_load(const String &path, const String &original_path, bool use_sub_threads, int32_t cache_mode) const {
+    ERR_FAIL_COND_V_MSG(!FileAccess::file_exists(path), ERR_FILE_NOT_FOUND, "NEATModel Load Error: File does not exist");
+    PackedByteArray bytes = FileAccess::get_file_as_bytes(path);
+
+    champion_log::Header header;
+    std::vector<champion_log::Connection> connections;
+    std::string error;
+    bool decoded = network_model::decode(bytes.ptr(), bytes.size(), header, connections, error);
+    ERR_FAIL_COND_V_MSG(!decoded, ERR_FILE_CORRUPT, ("NEATModel Load Error: " + error).c_str());
+
+    Ref<NEATModel> resource;
+    resource.instantiate();
+    resource->model = network_model::acquire(header, connections);
+    return resource;
+}
+
+Error ResourceFormatSaverNEATModel::_save(const Ref<Resource> &resource, const String &path, uint32_t flags){
+    Ref<NEATModel> model = resource;
+    ERR_FAIL_COND_V_MSG(model.is_null() || model->model == nullptr, ERR_INVALID_PARAMETER, "NEATModel Save Error: Resource is not a model with a network");
+
+    std::vector<uint8_t> encoded;
+    network_model::encode(*model->model, encoded);
+    PackedByteArray bytes;
+    bytes.resize((int64_t)encoded.size());
+    if (!encoded.empty()) std::memcpy(bytes.ptrw(), encoded.data(), encoded.size());
+
+    Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE);
+    ERR_FAIL_COND_V_MSG(file.is_null(), ERR_FILE_CANT_WRITE, "NEATModel Save Error: Cannot open file for writing");
+    file->store_buffer(bytes);
+    file->close();
+    return OK;
+}
+
+bool ResourceFormatSaverNEATModel::_recognize(const Ref<Resource> &resource) const {
+    return Object::cast_to<NEATModel>(resource.ptr()) != nullptr;
+}
+
+PackedStringArray ResourceFormatSaverNEATModel::_get_recognized_extensions(const Ref<Resource> &resource) const {
+    PackedStringArray extensions;
+    if (_recognize(resource)) extensions.push_back("neatmodel");
+    return extensions;
+}
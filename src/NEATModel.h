@@ -0,0 +1,59 @@
+#ifndef NEATMODEL_H
+#define NEATMODEL_H
+
+#include <memory>
+#include "NetworkModel.h"
+#include "NetworkAgent.h"
+#include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/classes/resource_format_loader.hpp>
+#include <godot_cpp/classes/resource_format_saver.hpp>
+
+namespace godot {
+
+    //Exported network as a resource. Load it once (ResourceLoader also caches it by path) and create as many agents from it as needed,
+    //they all read the same compiled model
+    class NEATModel : public Resource {
+        GDCLASS(NEATModel, Resource);
+        friend class ResourceFormatLoaderNEATModel;
+        friend class ResourceFormatSaverNEATModel;
+        friend class NEATAgent;
+        friend class ChampionLogReader;
+    protected:
+        static void _bind_methods();
+    private:
+        std::shared_ptr<const NetworkModel> model;
+
+    public:
+        void set_network_data(Array network_data);
+        Array get_network_data();
+        Ref<NetworkAgent> create_agent();
+        int get_input_count();
+        int get_output_count();
+        int get_connection_count();
+        static int get_cached_model_count();
+    };
+
+    //Binary .neatmodel files, see network_model in NetworkModel.h for the layout
+    class ResourceFormatLoaderNEATModel : public ResourceFormatLoader {
+        GDCLASS(ResourceFormatLoaderNEATModel, ResourceFormatLoader);
+    protected:
+        static void _bind_methods() {}
+    public:
+        PackedStringArray _get_recognized_extensions() const override;
+        bool _handles_type(const StringName &type) const override;
+        String _get_resource_type(const String &path) const override;
+        Variant _load(const String &path, const String &original_path, bool use_sub_threads, int32_t cache_mode) const override;
+    };
+
+    class ResourceFormatSaverNEATModel : public ResourceFormatSaver {
+        GDCLASS(ResourceFormatSaverNEATModel, ResourceFormatSaver);
+    protected:
+        static void _bind_methods() {}
+    public:
+        Error _save(const Ref<Resource> &resource, const String &path, uint32_t flags) override;
+        bool _recognize(const Ref<Resource> &resource) const override;
+        PackedStringArray _get_recognized_extensions(const Ref<Resource> &resource) const override;
+    };
+};
+
+#endif
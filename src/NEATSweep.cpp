@@ -0,0 +1,280 @@
+#include "NEATSweep.h"
+#include "NEATAgent.h"
+#include "Network.h"
+#include "Parallel.h"
+#include "Random.h"
+#include <godot_cpp/classes/project_settings.hpp>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace godot;
+
+//Summary column order, get_setting and apply_setting use the same numbering
+const char* NEATSweep::SETTING_NAMES[] = {"population_size", "desired_species_count", "initial_enabled_percent", "compatibility_threshold", "rate_weight_mutate",
+                                          "rate_connection_mutate", "rate_enable_mutate", "rate_node_mutate", "hidden_activation", "output_activation", nullptr};
+
+void NEATSweep::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_dataset", "inputs", "targets", "input_size", "target_size"), &NEATSweep::set_dataset);
+    ClassDB::bind_method(D_METHOD("load_dataset_file", "path"), &NEATSweep::load_dataset_file);
+    ClassDB::bind_method(D_METHOD("set_task", "loss", "target", "max_generations", "batch_size"), &NEATSweep::set_task, DEFVAL("mse"), DEFVAL(0.01), DEFVAL(100), DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("set_seed", "seed"), &NEATSweep::set_seed);
+    ClassDB::bind_method(D_METHOD("add_configuration", "settings"), &NEATSweep::add_configuration);
+    ClassDB::bind_method(D_METHOD("add_grid", "values"), &NEATSweep::add_grid);
+    ClassDB::bind_method(D_METHOD("add_random_configurations", "ranges", "count"), &NEATSweep::add_random_configurations);
+    ClassDB::bind_method(D_METHOD("clear_configurations"), &NEATSweep::clear_configurations);
+    ClassDB::bind_method(D_METHOD("get_configuration_count"), &NEATSweep::get_configuration_count);
+    ClassDB::bind_method(D_METHOD("run", "thread_count", "summary_path"), &NEATSweep::run, DEFVAL(0), DEFVAL(""));
+}
+
+bool NEATSweep::set_dataset(PackedFloat32Array inputs, PackedFloat32Array targets, int input_size, int target_size){ //NOTE: Rows are packed back to back, inputs without the bias. Runs get input_size inputs (plus the bias, which NEATAgent adds) and target_size outputs
+    ERR_FAIL_COND_V_MSG(input_size < 1 || target_size < 1, false, "NEATSweep Dataset Error: Input and target sizes must be greater than 0");
+    bool loaded = this->dataset.set_arrays(NEATAgent::packed_to_vector_float(inputs), NEATAgent::packed_to_vector_float(targets), input_size, target_size);
+    ERR_FAIL_COND_V_MSG(!loaded, false, ("NEATSweep Dataset Error: " + this->dataset.last_error).c_str());
+    return true;
+}
+
+bool NEATSweep::load_dataset_file(String path){ //NOTE: Same file layout as NEATAgent.load_dataset_file, the mapping is shared by every run
+    std::string path_str = ProjectSettings::get_singleton()->globalize_path(path).utf8().get_data();
+    bool loaded = this->dataset.map_file(path_str);
+    ERR_FAIL_COND_V_MSG(!loaded, false, ("NEATSweep Dataset Error: " + this->dataset.last_error).c_str());
+    return true;
+}
+
+bool NEATSweep::set_task(String loss, float target, int max_generations, int batch_size){ //NOTE: A run reaches the target when its best loss is at or below it, or for "accuracy" when its best accuracy is at or above it
+    std::string loss_str = loss.utf8().get_data();
+    ERR_FAIL_COND_V_MSG(loss_str != "mse" && loss_str != "cross_entropy" && loss_str != "accuracy", false, "NEATSweep Task Error: Loss must be \"mse\", \"cross_entropy\", or \"accuracy\"");
+    ERR_FAIL_COND_V_MSG(max_generations < 1, false, "NEATSweep Task Error: Max generations must be greater than 0");
+    ERR_FAIL_COND_V_MSG(batch_size < 0, false, "NEATSweep Task Error: Batch size must be 0 (every row) or greater");
+
+    if (loss_str == "cross_entropy") this->loss = Dataset::LOSS_CROSS_ENTROPY;
+    else if (loss_str == "accuracy") this->loss = Dataset::LOSS_ACCURACY;
+    else this->loss = Dataset::LOSS_MSE;
+    this->target = target;
+    this->max_generations = max_generations;
+    this->batch_size = batch_size;
+    return true;
+}
+
+void NEATSweep::set_seed(int64_t seed){ //NOTE: Run seeds and random configurations are derived from this, so the same sweep repeats exactly
+    this->seed = (uint64_t)seed;
+}
+
+bool NEATSweep::apply_setting(SweepConfig &config, const String &key, const Variant &value){
+    if (key == "hidden_activation" || key == "output_activation"){
+        if (value.get_type() != Variant::STRING) return false;
+        String function = value;
+        if (Network::activation_code(function.utf8().get_data()) == -1) return false;
+        if (key == "hidden_activation") config.hidden_activation = function;
+        else config.output_activation = function;
+        return true;
+    }
+
+    if (value.get_type() != Variant::INT && value.get_type() != Variant::FLOAT) return false;
+    double number = value;
+    bool is_rate = number >= 0.0 && number <= 1.0;
+
+    if (key == "population_size") config.population_size = (int)number;
+    else if (key == "desired_species_count") config.desired_species_count = (int)number;
+    else if (key == "compatibility_threshold") config.compatibility_threshold = number;
+    else if (!is_rate) return false;
+    else if (key == "initial_enabled_percent") config.initial_enabled_percent = number;
+    else if (key == "rate_weight_mutate") config.rate_weight_mutate = number;
+    else if (key == "rate_connection_mutate") config.rate_connection_mutate = number;
+    else if (key == "rate_enable_mutate") config.rate_enable_mutate = number;
+    else if (key == "rate_node_mutate") config.rate_node_mutate = number;
+    else return false;
+    return true;
+}
+
+Variant NEATSweep::get_setting(const SweepConfig &config, int setting){
+    switch (setting){
+    case 0: return config.population_size;
+    case 1: return config.desired_species_count;
+    case 2: return config.initial_enabled_percent;
+    case 3: return config.compatibility_threshold;
+    case 4: return config.rate_weight_mutate;
+    case 5: return config.rate_connection_mutate;
+    case 6: return config.rate_enable_mutate;
+    case 7: return config.rate_node_mutate;
+    case 8: return config.hidden_activation;
+    default: return config.output_activation;
+    }
+}
+
+bool NEATSweep::add_configuration(Dictionary settings){ //NOTE: Keys are the names of initialize_population and set_mutation_rates arguments plus compatibility_threshold
+    SweepConfig config;
+    Array keys = settings.keys();
+    for (int i = 0; i < keys.size(); i++){
+        String key = keys[i];
+        ERR_FAIL_COND_V_MSG(!apply_setting(config, key, settings[keys[i]]), false, ("NEATSweep Configuration Error: Invalid value for " + std::string(key.utf8().get_data())).c_str());
+    }
+    this->configs.push_back(config);
+    return true;
+}
+
+int NEATSweep::add_grid(Dictionary values){ //NOTE: Each key maps to an Array of values, every combination becomes a configuration. Returns how many were added
+    std::vector<SweepConfig> grid(1);
+    Array keys = values.keys();
+    for (int i = 0; i < keys.size(); i++){
+        String key = keys[i];
+        ERR_FAIL_COND_V_MSG(values[keys[i]].get_type() != Variant::ARRAY, 0, ("NEATSweep Configuration Error: Grid values for " + std::string(key.utf8().get_data()) + " must be an Array").c_str());
+        Array options = values[keys[i]];
+        ERR_FAIL_COND_V_MSG(options.is_empty(), 0, ("NEATSweep Configuration Error: Grid values for " + std::string(key.utf8().get_data()) + " are empty").c_str());
+
+        //Every configuration so far gets one copy per option
+        std::vector<SweepConfig> expanded;
+        expanded.reserve(grid.size() * options.size());
+        for (const SweepConfig &config : grid){
+            for (int j = 0; j < options.size(); j++){
+                SweepConfig option = config;
+                ERR_FAIL_COND_V_MSG(!apply_setting(option, key, options[j]), 0, ("NEATSweep Configuration Error: Invalid value for " + std::string(key.utf8().get_data())).c_str());
+                expanded.push_back(option);
+            }
+        }
+        grid.swap(expanded);
+    }
+
+    this->configs.insert(this->configs.end(), grid.begin(), grid.end());
+    return grid.size();
+}
+
+int NEATSweep::add_random_configurations(Dictionary ranges, int count){ //NOTE: Each key maps to [min, max] (whole numbers give whole values), activations map to an Array of choices
+    ERR_FAIL_COND_V_MSG(count < 1, 0, "NEATSweep Configuration Error: Count must be greater than 0");
+
+    Array keys = ranges.keys();
+    for (int i = 0; i < keys.size(); i++){
+        String key = keys[i];
+        ERR_FAIL_COND_V_MSG(ranges[keys[i]].get_type() != Variant::ARRAY, 0, ("NEATSweep Configuration Error: Range for " + std::string(key.utf8().get_data()) + " must be an Array").c_str());
+        Array range = ranges[keys[i]];
+        bool choices = key == "hidden_activation" || key == "output_activation";
+        ERR_FAIL_COND_V_MSG(choices ? range.is_empty() : range.size() != 2, 0, ("NEATSweep Configuration Error: Range for " + std::string(key.utf8().get_data()) + " must be [min, max] or a list of activations").c_str());
+    }
+
+    //Sampled from the sweep seed and the configuration's position, so adding the same ranges again gives new configurations
+    std::vector<SweepConfig> sampled(count);
+    for (int c = 0; c < count; c++){
+        NEATRandom gen = NEATRandom(this->seed).stream(-1, this->configs.size() + c);
+        for (int i = 0; i < keys.size(); i++){
+            String key = keys[i];
+            Array range = ranges[keys[i]];
+            Variant value;
+            if (key == "hidden_activation" || key == "output_activation"){
+                value = range[std::uniform_int_distribution<int>(0, range.size() - 1)(gen)];
+            }
+            else if (range[0].get_type() == Variant::INT && range[1].get_type() == Variant::INT){
+                int64_t low = range[0];
+                int64_t high = range[1];
+                value = std::uniform_int_distribution<int64_t>(std::min(low, high), std::max(low, high))(gen);
+            }
+            else{
+                double low = range[0];
+                double high = range[1];
+                value = low + (high - low) * gen.uniform();
+            }
+            ERR_FAIL_COND_V_MSG(!apply_setting(sampled[c], key, value), 0, ("NEATSweep Configuration Error: Invalid range for " + std::string(key.utf8().get_data())).c_str());
+        }
+    }
+
+    this->configs.insert(this->configs.end(), sampled.begin(), sampled.end());
+    return count;
+}
+
+void NEATSweep::clear_configurations(){
+    this->configs.clear();
+}
+
+int NEATSweep::get_configuration_count(){
+    return this->configs.size();
+}
+
+bool NEATSweep::reached_target(float best){
+    if (this->loss == Dataset::LOSS_ACCURACY) return best >= this->target;
+    return best <= this->target;
+}
+
+NEATSweep::SweepResult NEATSweep::run_configuration(const SweepConfig &config, uint64_t run_seed){
+    SweepResult result;
+    result.seed = run_seed;
+    auto start = std::chrono::steady_clock::now();
+
+    NEATAgent* agent = memnew(NEATAgent);
+    agent->set_seed((int64_t)run_seed);
+    agent->initialize_population(this->dataset.input_size, this->dataset.target_size, config.population_size, config.hidden_activation, config.output_activation, config.desired_species_count, config.initial_enabled_percent);
+    if (agent->population.empty() || agent->guess_input_size() != this->dataset.input_size || agent->guess_output_size() != this->dataset.target_size){
+        result.failed = true;
+        memdelete(agent);
+        return result;
+    }
+    agent->set_mutation_rates(config.rate_weight_mutate, config.rate_connection_mutate, config.rate_enable_mutate, config.rate_node_mutate);
+    agent->compatibility_threshold = config.compatibility_threshold;
+
+    //Runs already share the thread pool, so each one evaluates on its own thread. Memory is sampled once per generation, after evaluation
+    result.best = (this->loss == Dataset::LOSS_ACCURACY) ? 0.0f : INFINITY;
+    for (int generation = 0; generation < this->max_generations; generation++){
+        float best = agent->evaluate_rows(&this->dataset, this->loss, this->batch_size, 1);
+        if (this->loss == Dataset::LOSS_ACCURACY) result.best = std::max(result.best, best);
+        else result.best = std::min(result.best, best);
+        result.peak_memory_bytes = std::max(result.peak_memory_bytes, (int64_t)agent->get_total_memory_usage());
+
+        if (reached_target(best)){
+            result.generations_to_target = generation;
+            break;
+        }
+        agent->next_generation();
+    }
+
+    result.wall_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    memdelete(agent);
+    return result;
+}
+
+bool NEATSweep::write_summary(const std::string &path, const std::vector<SweepResult> &results){
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) return false;
+
+    fprintf(file, "run,seed");
+    for (int s = 0; SETTING_NAMES[s] != nullptr; s++) fprintf(file, ",%s", SETTING_NAMES[s]);
+    fprintf(file, ",failed,generations_to_target,best,wall_time_ms,peak_memory_bytes\n");
+
+    for (int i = 0; i < results.size(); i++){
+        const SweepConfig &c = this->configs[i];
+        const SweepResult &r = results[i];
+        fprintf(file, "%d,%llu,%d,%d,%g,%g,%g,%g,%g,%g,%s,%s,%d,%d,%g,%.1f,%lld\n", i, (unsigned long long)r.seed, c.population_size, c.desired_species_count,
+                c.initial_enabled_percent, c.compatibility_threshold, c.rate_weight_mutate, c.rate_connection_mutate, c.rate_enable_mutate, c.rate_node_mutate,
+                c.hidden_activation.utf8().get_data(), c.output_activation.utf8().get_data(), (int)r.failed, r.generations_to_target, r.best, r.wall_time_ms,
+                (long long)r.peak_memory_bytes);
+    }
+    return fclose(file) == 0;
+}
+
+Array NEATSweep::run(int thread_count, String summary_path){ //NOTE: Blocks until every run is done, call it from a thread or a headless script. Returns one Dictionary per configuration
+    ERR_FAIL_COND_V_MSG(!this->dataset.is_loaded(), Array(), "NEATSweep Run Error: No dataset loaded");
+    ERR_FAIL_COND_V_MSG(this->configs.empty(), Array(), "NEATSweep Run Error: No configurations added");
+
+    std::vector<SweepResult> results(this->configs.size());
+    parallel_for(this->configs.size(), thread_count, [this, &results](int i) {
+        results[i] = run_configuration(this->configs[i], NEATRandom(this->seed).stream(-2, i)());
+    });
+
+    if (!summary_path.is_empty()){
+        std::string path_str = ProjectSettings::get_singleton()->globalize_path(summary_path).utf8().get_data();
+        if (!write_summary(path_str, results)) ERR_PRINT(("NEATSweep Run Error: Could not write summary to " + path_str).c_str());
+    }
+
+    Array table;
+    for (int i = 0; i < results.size(); i++){
+        Dictionary row;
+        row["run"] = i;
+        row["seed"] = (int64_t)results[i].seed;
+        for (int s = 0; SETTING_NAMES[s] != nullptr; s++) row[SETTING_NAMES[s]] = get_setting(this->configs[i], s);
+        row["failed"] = results[i].failed;
+        row["generations_to_target"] = results[i].generations_to_target;
+        row["best"] = results[i].best;
+        row["wall_time_ms"] = results[i].wall_time_ms;
+        row["peak_memory_bytes"] = results[i].peak_memory_bytes;
+        table.append(row);
+    }
+    return table;
+}
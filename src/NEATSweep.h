@@ -0,0 +1,72 @@
+#ifndef NEATSWEEP_H
+#define NEATSWEEP_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Dataset.h"
+#include <godot_cpp/classes/ref_counted.hpp>
+
+namespace godot {
+
+    //Headless hyperparameter sweep. Every configuration is a separate NEATAgent evolved against a shared dataset until its best
+    //network reaches the target or max_generations pass. Runs go on a thread pool, each run evaluating on its own thread
+    class NEATSweep : public RefCounted {
+        GDCLASS(NEATSweep, RefCounted);
+    protected:
+        static void _bind_methods();
+    private:
+        //One run, values not given in a configuration keep initialize_population and set_mutation_rates defaults
+        struct SweepConfig {
+            int population_size = 100;
+            int desired_species_count = 5;
+            float initial_enabled_percent = 0.25;
+            float compatibility_threshold = 3.0;
+            float rate_weight_mutate = 0.8;
+            float rate_connection_mutate = 0.1;
+            float rate_enable_mutate = 0.05;
+            float rate_node_mutate = 0.03;
+            String hidden_activation = "tanh";
+            String output_activation = "tanh";
+        };
+        struct SweepResult {
+            bool failed = false;
+            uint64_t seed = 0;
+            int generations_to_target = -1;
+            float best = 0.0;
+            double wall_time_ms = 0.0;
+            int64_t peak_memory_bytes = 0;
+        };
+
+        std::vector<SweepConfig> configs;
+        Dataset dataset;
+        Dataset::Loss loss = Dataset::LOSS_MSE;
+        int batch_size = 0;
+        int max_generations = 100;
+        float target = 0.01;
+        uint64_t seed = 0;
+
+        static const char* SETTING_NAMES[];
+        static bool apply_setting(SweepConfig &config, const String &key, const Variant &value);
+        static Variant get_setting(const SweepConfig &config, int setting);
+        bool reached_target(float best);
+        SweepResult run_configuration(const SweepConfig &config, uint64_t run_seed);
+        bool write_summary(const std::string &path, const std::vector<SweepResult> &results);
+
+    public:
+        bool set_dataset(PackedFloat32Array inputs, PackedFloat32Array targets, int input_size, int target_size);
+        bool load_dataset_file(String path);
+        bool set_task(String loss = "mse", float target = 0.01f, int max_generations = 100, int batch_size = 0);
+        void set_seed(int64_t seed);
+
+        bool add_configuration(Dictionary settings);
+        int add_grid(Dictionary values);
+        int add_random_configurations(Dictionary ranges, int count);
+        void clear_configurations();
+        int get_configuration_count();
+
+        Array run(int thread_count = 0, String summary_path = "");
+    };
+};
+
+#endif
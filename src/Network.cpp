@@ -1,5 +1,9 @@
 #include "Network.h"
 #include "NEATAgent.h"
+#include "MemoryUsage.h"
+#include "Trace.h"
+#include <unordered_map>
+#include <cstring>
 
 float Network::activation_func(float x, std::string type){
     if (type == "relu"){
@@ -17,74 +21,102 @@ float Network::activation_func(float x, std::string type){
     return 0.0;
 }
 
+int Network::activation_code(const std::string &type){
+    //Numbering used by extract_champion_data, NetworkAgent and worker processes
+    if (type == "relu") return 0;
+    if (type == "linear") return 1;
+    if (type == "sigmoid") return 2;
+    if (type == "tanh") return 3;
+    return -1;
+}
+
+worker_protocol::EncodedNetwork Network::encode_compiled(){
+    worker_protocol::EncodedNetwork encoded;
+    encoded.inputs = this->inputs;
+    encoded.outputs = this->outputs;
+    encoded.hidden_function = activation_code(this->hidden_func_str);
+    encoded.output_function = activation_code(this->output_func_str);
+    encoded.kind.assign(this->compiled_kind.begin(), this->compiled_kind.end());
+    encoded.io_index.assign(this->compiled_io_index.begin(), this->compiled_io_index.end());
+    encoded.edge_start.assign(this->compiled_edge_start.begin(), this->compiled_edge_start.end());
+    encoded.edge_to.assign(this->compiled_edge_to.begin(), this->compiled_edge_to.end());
+    encoded.edge_weight = this->compiled_edge_weight;
+    return encoded;
+}
+
 std::vector<float> Network::guess(std::vector<float> inputs){
-    std::vector<float> outputs;
-    int inputs_passed = 0;
+    NEAT_TRACE_SCOPE("network_guess", "inference");
+    std::vector<float> outputs(this->outputs, 0.0f);
 
-    //Cycle through every single neuron
-    for (int i = 0; i < ordered_by_depth.size(); i++){
-        Neuron* current_neuron = this->neurons[ordered_by_depth[i]];
+    //Reset values from the last guess
+    std::fill(this->compiled_values.begin(), this->compiled_values.end(), 0.0f);
 
-        //If input neuron, set accumulated value to the input
-        if (current_neuron->depth == 0.0){
-            current_neuron->accumulated_value = inputs[inputs_passed++];
-        }
-        //If not first layer, apply the hidden func
-        else{
-            if (current_neuron->depth != 1.0){
-                current_neuron->accumulated_value = activation_func(current_neuron->accumulated_value, this->hidden_func_str);
-            }
-        }
+    //Cycle through every live neuron in depth order
+    for (int i = 0; i < this->compiled_kind.size(); i++){
+        float value = this->compiled_values[i];
 
-        //If last layer, apply the output func
-        if (current_neuron->depth == 1.0){
-            current_neuron->accumulated_value = activation_func(current_neuron->accumulated_value, this->output_func_str);
-            outputs.push_back(current_neuron->accumulated_value);
+        //If input neuron, set value to the input
+        if (this->compiled_kind[i] == KIND_INPUT){
+            value = inputs[this->compiled_io_index[i]];
+        }
+        //If last layer, apply the output func and dont pass it on
+        else if (this->compiled_kind[i] == KIND_OUTPUT){
+            outputs[this->compiled_io_index[i]] = activation_func(value, this->output_func_str);
+            continue;
         }
-        //Multiply accumulated value (input) by weights
+        //Otherwise hidden so apply the hidden func
         else{
-            for (auto const& [to, weight] : current_neuron->to_connections){
-                neurons[to]->accumulated_value += current_neuron->accumulated_value * weight;
-            }
+            value = activation_func(value, this->hidden_func_str);
         }
-    }
 
-    //Once the neuron is done with, set accumulated value to 0 for next guess
-    for (auto& neuron: neurons){
-        Neuron* current_neuron = neuron.second;
-        current_neuron->accumulated_value = 0.0;
+        //Multiply value (input) by weights
+        for (int e = this->compiled_edge_start[i]; e < this->compiled_edge_start[i+1]; e++){
+            this->compiled_values[this->compiled_edge_to[e]] += value * this->compiled_edge_weight[e];
+        }
     }
 
     return outputs;
 }
 
-void Network::weight_mutation(std::mt19937 &gen){
-    std::uniform_real_distribution<float> prob(0.0, 1.0);
-    std::uniform_real_distribution<float> random_weight(-5.0, 5.0);
-    std::normal_distribution<float> nudge(0.0f, 0.13f);
-
-    for (int i = 0; i < this->connection_data.size(); i++){
-        //10% chance to leave this weight exactly as is
-        if (prob(gen) > 0.90f) continue; 
-
-        //10% chance to completely rerandomize this weights value
-        if (prob(gen) < 0.10f) {
-            this->connection_data[i][2] = random_weight(gen);
-        }
-        //80% chance to nudge it
-        else {
-            //Multiplied by weight chance so decreaing the chance decreases the nudge. This is useful for late stage fine tune training
-            this->connection_data[i][2] += nudge(gen) * (this->parent_agent->rate_weight_mutate);
-        }
-
-        //Clamp weights to prevent them from drifting too far
-        float cap = 100.0f;
-        if (this->connection_data[i][2] > cap) this->connection_data[i][2] = cap;
-        if (this->connection_data[i][2] < -cap) this->connection_data[i][2] = -cap;
+void Network::weight_mutation(NEATRandom &gen){
+    //Weights are gathered into one contiguous array and every random number for the genome is drawn in bulk up front
+    //(normals from the ziggurat), so the mutation loop itself has no per gene branches and can be vectorized
+    int count = this->connection_data.size();
+    if (count == 0) return;
+
+    thread_local std::vector<float> weights;
+    thread_local std::vector<float> nudges;
+    thread_local std::vector<uint64_t> bits;
+    weights.resize(count);
+    nudges.resize(count);
+    bits.resize(2 * count);
+    gen.fill(bits.data(), 2 * count);
+    gen.fill_normal(nudges.data(), count);
+
+    for (int i = 0; i < count; i++) weights[i] = this->connection_data[i][2];
+
+    //Multiplied by weight chance so decreaing the chance decreases the nudge. This is useful for late stage fine tune training
+    float nudge_scale = 0.13f * this->parent_agent->rate_weight_mutate;
+    //Clamp weights to prevent them from drifting too far
+    const float cap = 100.0f;
+    const float to_unit = 1.0f / 16777216.0f;
+    for (int i = 0; i < count; i++){
+        uint64_t choice = bits[2 * i];
+        float keep_roll = (float)(choice >> 40) * to_unit;
+        float reroll_roll = (float)((choice >> 16) & 0xFFFFFF) * to_unit;
+        float random_weight = (float)(bits[2 * i + 1] >> 40) * to_unit * 10.0f - 5.0f;
+
+        //10% chance to leave this weight exactly as is, otherwise 10% chance to completely rerandomize it and 80% to nudge it
+        float mutated = (reroll_roll < 0.10f) ? random_weight : weights[i] + nudges[i] * nudge_scale;
+        mutated = std::min(std::max(mutated, -cap), cap);
+        weights[i] = (keep_roll > 0.90f) ? weights[i] : mutated;
     }
+
+    for (int i = 0; i < count; i++) this->connection_data[i][2] = weights[i];
 }
 
-void Network::add_connection(std::mt19937 &gen){
+void Network::add_connection(NEATRandom &gen){
+    //Connections only go forward in the depth data, so it stays a topological order without re-sorting
     int end_hidden = this->temporary_depth_data.size()-this->outputs-1;
     //First neuron chosen must not be one of the output layer
     std::uniform_int_distribution<> dist1(0, end_hidden);
@@ -123,7 +155,7 @@ void Network::add_connection(std::mt19937 &gen){
     }
 }
 
-void Network::toggle_enable(std::mt19937 &gen){
+void Network::toggle_enable(NEATRandom &gen){
     if (this->connection_data.empty()) return;
 
     //Choose a random connection
@@ -139,7 +171,7 @@ void Network::toggle_enable(std::mt19937 &gen){
     }
 }
 
-void Network::add_neuron(std::mt19937 &gen){
+void Network::add_neuron(NEATRandom &gen){
     std::uniform_int_distribution<> distr(0, this->connection_data.size()-1);
 
     //Choosen connection
@@ -148,7 +180,7 @@ void Network::add_neuron(std::mt19937 &gen){
     //Extract necessary data
     int from_neuron_id = this->connection_data[chosen_connection][0];
     int to_neuron_id = this->connection_data[chosen_connection][1];
-    int new_neuron_id = this->parent_agent->neuron_counter++;
+    int new_neuron_id = this->parent_agent->registry->new_neuron_id();
 
     int from_neuron_index = -1;
     int to_neuron_index = -1;
@@ -166,8 +198,9 @@ void Network::add_neuron(std::mt19937 &gen){
     //Disable the current connection from A->B
     this->connection_data[chosen_connection][3] = 1.0;
 
-    //Add connection A->C and C->B
+    //Add connection A->C and C->B. C goes between A and B but stays inside the hidden block so the depth data remains inputs, hiddens in topological order, outputs
     int new_neuron_index = ceil(from_neuron_index + (to_neuron_index - from_neuron_index) / 2.0);
+    new_neuron_index = std::clamp(new_neuron_index, this->inputs, (int)this->temporary_depth_data.size() - this->outputs);
     this->temporary_depth_data.insert(this->temporary_depth_data.begin() + new_neuron_index, new_neuron_id);
 
     connect_neurons(&this->connection_data, this->connection_data[chosen_connection][0], new_neuron_id, 1.0);
@@ -175,67 +208,141 @@ void Network::add_neuron(std::mt19937 &gen){
 }
 
 void Network::build_network_structure(){
-    int hidden_count = 0;
+    //temporary_depth_data is kept in topological order by add_neuron and add_connection, so the evaluation order is read off it
+    //in one pass instead of sorting. Inputs and outputs are pulled to the ends in case the depth data came from elsewhere
+    ordered_by_depth.clear();
+    ordered_by_depth.reserve(this->temporary_depth_data.size());
     for (int id : this->temporary_depth_data) {
-        bool is_input = (id < inputs);
-        bool is_output = (id >= inputs && id < inputs + outputs);
-        if (!is_input && !is_output) hidden_count++;
+        if (id < inputs) ordered_by_depth.push_back(id);
+    }
+    for (int id : this->temporary_depth_data) {
+        if (id >= inputs + outputs) ordered_by_depth.push_back(id);
+    }
+    for (int id : this->temporary_depth_data) {
+        if (id >= inputs && id < inputs + outputs) ordered_by_depth.push_back(id);
     }
 
-    int hiddens_passed = 0;
+    compile_live_network();
+}
 
-    for (int i = 0; i < this->temporary_depth_data.size(); i++) {
-        int neuron_id = this->temporary_depth_data[i];
-        float new_depth = 0.5f;
+void Network::compile_live_network(){
+    //The genome (depth data, connection_data) keeps every neuron for evolution, but only neurons that can affect an output are compiled for guess
+    int neuron_count = this->ordered_by_depth.size();
 
-        //Its an input neuron so depth is 0
-        if (neuron_id < inputs) {
-            new_depth = 0.0f;
-        }
-        //Its an output neuron so depth is 1
-        else if (neuron_id >= inputs && neuron_id < inputs + outputs) {
-            new_depth = 1.0f;
+    std::unordered_map<int, int> position;
+    for (int i = 0; i < neuron_count; i++) position[this->ordered_by_depth[i]] = i;
+
+    std::vector<int> kind(neuron_count);
+    for (int i = 0; i < neuron_count; i++){
+        int neuron_id = this->ordered_by_depth[i];
+        if (neuron_id < this->inputs) kind[i] = KIND_INPUT;
+        else if (neuron_id < this->inputs + this->outputs) kind[i] = KIND_OUTPUT;
+        else kind[i] = KIND_HIDDEN;
+    }
+
+    //Only keep enabled connections that guess can actually use: outputs never pass values on, and a connection into an input or an already evaluated neuron is never read
+    std::vector<std::vector<std::pair<int, int>>> used_connections(neuron_count); //To position, gene index
+    for (int g = 0; g < this->connection_data.size(); g++){
+        const std::vector<float> &connection = this->connection_data[g];
+        if (connection[3] == 0.0f) continue;
+
+        auto from = position.find((int)connection[0]);
+        auto to = position.find((int)connection[1]);
+        if (from == position.end() || to == position.end()) continue;
+
+        int i = from->second;
+        int to_position = to->second;
+        if (kind[i] == KIND_OUTPUT || to_position <= i || kind[to_position] == KIND_INPUT) continue;
+        used_connections[i].push_back({to_position, g});
+    }
+
+    //A repeated from/to pair only keeps its last gene
+    for (std::vector<std::pair<int, int>> &edges : used_connections){
+        if (edges.size() < 2) continue;
+        std::sort(edges.begin(), edges.end());
+        auto last = std::unique(edges.rbegin(), edges.rend(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first == b.first; });
+        edges.erase(edges.begin(), last.base());
+    }
+
+    //Backward pass: neurons with a path to an output
+    std::vector<bool> reaches_output(neuron_count, false);
+    for (int i = neuron_count - 1; i >= 0; i--){
+        if (kind[i] == KIND_OUTPUT){
+            reaches_output[i] = true;
+            continue;
         }
-        else {
-            //Hidden neuron so calculate depth based on ordering
-            if (hidden_count > 0) {
-                float sep_amount = 1.0f / (hidden_count + 1);
-                hiddens_passed++;
-                new_depth = sep_amount * hiddens_passed;
-            } else {
-                new_depth = 0.5f;
+        for (auto const& [to_position, gene] : used_connections[i]){
+            if (reaches_output[to_position]){
+                reaches_output[i] = true;
+                break;
             }
         }
+    }
 
-        //Create new neuron
-        Neuron* new_neuron = new Neuron(neuron_id, new_depth);
-        neurons.insert({neuron_id, new_neuron});
+    //Forward pass: neurons with a path from an input. A hidden neuron with no input still outputs hidden_func(0), so it only counts as dead when that is 0
+    bool hidden_outputs_constant = activation_func(0.0f, this->hidden_func_str) != 0.0f;
+    std::vector<bool> reached_from_input(neuron_count, false);
+    for (int i = 0; i < neuron_count; i++){
+        if (kind[i] == KIND_INPUT || (kind[i] == KIND_HIDDEN && hidden_outputs_constant)) reached_from_input[i] = true;
+        if (!reached_from_input[i]) continue;
+        for (auto const& [to_position, gene] : used_connections[i]){
+            reached_from_input[to_position] = true;
+        }
     }
 
-    // Connecting all neurons based on connection data
-    for (std::vector<float> connection: this->connection_data){
-        int from_neuron = (int)connection[0];
-        int to_neuron = (int)connection[1];
-        float weight = connection[2];
-        bool enabled = (bool)connection[3];
-        
-        //Ensure neuron exists
-        if (neurons.count(from_neuron) && neurons.count(to_neuron)) {
-            //Only add the connection if it is enabled
-            if (enabled == 1.0f) { 
-                neurons[from_neuron]->add_connection(to_neuron, weight);
-            }
+    //Assign compiled slots to live neurons (outputs always stay so guess returns every output)
+    std::vector<int> slot(neuron_count, -1);
+    this->compiled_kind.clear();
+    this->compiled_io_index.clear();
+    for (int i = 0; i < neuron_count; i++){
+        bool live = kind[i] == KIND_OUTPUT || (reaches_output[i] && reached_from_input[i]);
+        if (!live) continue;
+
+        int neuron_id = this->ordered_by_depth[i];
+        slot[i] = this->compiled_kind.size();
+        this->compiled_kind.push_back(kind[i]);
+        if (kind[i] == KIND_INPUT) this->compiled_io_index.push_back(neuron_id);
+        else if (kind[i] == KIND_OUTPUT) this->compiled_io_index.push_back(neuron_id - this->inputs);
+        else this->compiled_io_index.push_back(-1);
+    }
+
+    //Flatten live connections
+    this->compiled_edge_start.clear();
+    this->compiled_edge_to.clear();
+    this->compiled_edge_weight.clear();
+    this->compiled_gene_edge.assign(this->connection_data.size(), -1);
+    for (int i = 0; i < neuron_count; i++){
+        if (slot[i] == -1) continue;
+        this->compiled_edge_start.push_back(this->compiled_edge_to.size());
+        for (auto const& [to_position, gene] : used_connections[i]){
+            if (slot[to_position] == -1) continue;
+            this->compiled_gene_edge[gene] = this->compiled_edge_to.size();
+            this->compiled_edge_to.push_back(slot[to_position]);
+            this->compiled_edge_weight.push_back(this->connection_data[gene][2]);
         }
     }
+    this->compiled_edge_start.push_back(this->compiled_edge_to.size());
 
-    // Building the ordered_by_depth vector
-    ordered_by_depth.clear();
-    for (auto& neuron : neurons) {
-        ordered_by_depth.push_back(neuron.second->id);
+    this->compiled_values.assign(this->compiled_kind.size(), 0.0f);
+    compute_topology_hash();
+}
+
+void Network::clone_compiled_network(const Network* source){
+    //Same genes in the same order as source, so only the weights can differ from its compiled network
+    this->ordered_by_depth = source->ordered_by_depth;
+    this->compiled_kind = source->compiled_kind;
+    this->compiled_io_index = source->compiled_io_index;
+    this->compiled_edge_start = source->compiled_edge_start;
+    this->compiled_edge_to = source->compiled_edge_to;
+    this->compiled_edge_weight = source->compiled_edge_weight;
+    this->compiled_gene_edge = source->compiled_gene_edge;
+    this->compiled_values.assign(this->compiled_kind.size(), 0.0f);
+    this->topology_hash = source->topology_hash;
+
+    for (int g = 0; g < this->compiled_gene_edge.size(); g++){
+        int edge = this->compiled_gene_edge[g];
+        if (edge != -1) this->compiled_edge_weight[edge] = this->connection_data[g][2];
     }
-    std::sort(ordered_by_depth.begin(), ordered_by_depth.end(), [this](int a, int b) {
-        return this->neurons[a]->depth < this->neurons[b]->depth;
-    });
 }
 
 std::vector<int>& Network::get_depth_data(){
@@ -243,10 +350,14 @@ std::vector<int>& Network::get_depth_data(){
 }
 
 std::vector<std::vector<float>>& Network::get_connection_data(){
+    //Compacted genomes are rebuilt on demand, release_genome frees them again
+    if (this->genome_compacted && this->connection_data.empty()) this->genome_delta.apply(*this->genome_base, this->connection_data);
     return this->connection_data;
 }
 
-Network::Network(int inputs, int outputs, std::vector<int>* depth_data, std::vector<std::vector<float>>* connection_data, std::string h, std::string o, bool mutate, std::mt19937 &gen, godot::NEATAgent* parent_agent){
+Network::Network(int inputs, int outputs, std::vector<int>* depth_data, std::vector<std::vector<float>>* connection_data, std::string h, std::string o, bool mutate, NEATRandom &gen, godot::NEATAgent* parent_agent, const Network* structure_source){
+    NEAT_TRACE_SCOPE("build_network", "network");
+
     //Initialize fields
     this->parent_agent = parent_agent;
     
@@ -261,52 +372,76 @@ Network::Network(int inputs, int outputs, std::vector<int>* depth_data, std::vec
     std::uniform_real_distribution<float> rate(0.0, 1.0);
 
     //Random chance for mutations
+    bool structure_changed = false;
     if (mutate){
         std::uniform_real_distribution<float> dist(0.0, 1.0);
         int current_size = get_active_connection_count();
 
-        // Only allow growth if the network is small
+        // Only allow growth if the network is small and the population is within its memory budget
+        bool can_grow = current_size < parent_agent->size_cap && !parent_agent->structural_growth_blocked;
         if (dist(gen) < parent_agent->rate_node_mutate) {
-            if (current_size < parent_agent->size_cap) add_neuron(gen);
+            if (can_grow) {
+                add_neuron(gen);
+                structure_changed = true;
+            }
         }
         if (dist(gen) < parent_agent->rate_connection_mutate) {
-            if (current_size < parent_agent->size_cap) add_connection(gen);
+            if (can_grow) {
+                add_connection(gen);
+                structure_changed = true;
+            }
         }
 
-        if (dist(gen) < parent_agent->rate_enable_mutate) toggle_enable(gen);
+        if (dist(gen) < parent_agent->rate_enable_mutate) {
+            toggle_enable(gen);
+            structure_changed = true;
+        }
         if (dist(gen) < parent_agent->rate_weight_mutate) weight_mutation(gen);
     }
 
-    build_network_structure();
-}
-
-Network::~Network() {
-    //Delete all neuron objects
-    for (auto const& [id, neuron_ptr] : this->neurons) {
-        delete neuron_ptr;
-    }
+    //Weight only children reuse the compiled network of the parent their genes were copied from
+    if (structure_source != nullptr && !structure_changed && structure_source->compiled_gene_edge.size() == this->connection_data.size()) clone_compiled_network(structure_source);
+    else build_network_structure();
+    compute_genome_hash();
 }
 
 void Network::connect_neurons(std::vector<std::vector<float>>* connection_data, int first_id, int second_id, float weight){
     //Look at global table for connection pair
-    std::pair<int, int> id_pair = {first_id, second_id};
-    int innov_num;
-
-    //Didnt find so add the table connection
-    if (this->parent_agent->innovation_table.find(id_pair) == this->parent_agent->innovation_table.end()){
-        innov_num = this->parent_agent->innovation_table.size();
-        this->parent_agent->innovation_table[id_pair] = innov_num;
-    }
-    //Found so take that table slots innov number
-    else{
-        innov_num = this->parent_agent->innovation_table.at(id_pair);
-    }
+    int innov_num = this->parent_agent->registry->get_innovation(first_id, second_id);
 
     //Add the connection with the innov number
     std::vector<float> new_connection = {(float)first_id, (float)second_id, weight, 0.0, (float)innov_num};
     connection_data->push_back(new_connection);
 }
 
+void Network::compute_genome_hash(){
+    //Order independent sum over enabled genes, disabled genes and gene order dont change what the network computes
+    uint64_t hash = NEATRandom::mix((uint64_t)this->inputs * NEATRandom::GOLDEN_GAMMA + (uint64_t)this->outputs);
+    for (const std::vector<float> &conn : this->connection_data){
+        if (conn[3] <= 0.5) continue;
+
+        uint32_t weight_bits;
+        std::memcpy(&weight_bits, &conn[2], sizeof(weight_bits));
+        uint64_t link = ((uint64_t)(uint32_t)(int)conn[0] << 32) | (uint32_t)(int)conn[1];
+        hash += NEATRandom::mix(NEATRandom::mix(link) ^ weight_bits);
+    }
+    this->genome_hash = hash;
+}
+
+void Network::compute_topology_hash(){
+    //Everything in the compiled path except the weights
+    uint64_t hash = NEATRandom::mix((uint64_t)this->compiled_kind.size() * NEATRandom::GOLDEN_GAMMA + (uint64_t)this->compiled_edge_to.size());
+    for (int i = 0; i < this->compiled_kind.size(); i++) hash = NEATRandom::mix(hash ^ ((uint64_t)(uint32_t)this->compiled_kind[i] << 32 | (uint32_t)this->compiled_io_index[i]));
+    for (int i = 0; i < this->compiled_edge_start.size(); i++) hash = NEATRandom::mix(hash ^ (uint32_t)this->compiled_edge_start[i]);
+    for (int i = 0; i < this->compiled_edge_to.size(); i++) hash = NEATRandom::mix(hash ^ ((uint64_t)(uint32_t)this->compiled_edge_to[i] << 16));
+    this->topology_hash = hash;
+}
+
+bool Network::same_topology(const Network* other) const {
+    return this->topology_hash == other->topology_hash && this->compiled_kind == other->compiled_kind && this->compiled_io_index == other->compiled_io_index
+        && this->compiled_edge_start == other->compiled_edge_start && this->compiled_edge_to == other->compiled_edge_to;
+}
+
 int Network::get_active_connection_count(){
     int count = 0;
     //Only gets ennabled connections
@@ -316,4 +451,83 @@ int Network::get_active_connection_count(){
         }
     }
     return count;
+}
+
+int Network::count_enabled_genes(){
+    if (this->genome_compacted) return this->enabled_gene_count;
+
+    int count = 0;
+    for (const std::vector<float> &conn : this->connection_data) count += conn[3] > 0.5;
+    return count;
+}
+
+void Network::compact_genome(const Network* parent_a, const Network* parent_b){
+    this->enabled_gene_count = 0;
+    for (const std::vector<float> &conn : this->connection_data) this->enabled_gene_count += conn[3] > 0.5;
+
+    //Share a parent's base when the genome lines up with it, otherwise this genome becomes a base of its own
+    this->genome_base = nullptr;
+    for (const Network* parent : {parent_a, parent_b}){
+        if (parent == nullptr || !parent->genome_compacted) continue;
+        if (this->genome_delta.encode(*parent->genome_base, this->connection_data)){
+            this->genome_base = parent->genome_base;
+            break;
+        }
+    }
+    if (this->genome_base == nullptr){
+        this->genome_base = PackedGenome::pack(this->connection_data);
+        this->genome_delta.clear();
+    }
+
+    this->genome_compacted = true;
+    release_genome();
+}
+
+void Network::release_genome(){
+    if (this->genome_compacted) std::vector<std::vector<float>>().swap(this->connection_data);
+}
+
+void Network::expand_genome(){
+    get_connection_data();
+    this->genome_base = nullptr;
+    this->genome_delta = GenomeDelta();
+    this->genome_compacted = false;
+}
+
+size_t Network::get_genome_memory_usage(){
+    size_t bytes = memory_usage::nested_vector_bytes(this->connection_data) + memory_usage::vector_bytes(this->temporary_depth_data);
+
+    //A shared base is split evenly between the networks using it
+    if (this->genome_compacted) bytes += this->genome_base->get_memory_usage() / this->genome_base.use_count() + this->genome_delta.get_memory_usage();
+    return bytes;
+}
+
+size_t Network::get_phenotype_memory_usage(){
+    size_t bytes = sizeof(Network);
+
+    bytes += memory_usage::vector_bytes(this->ordered_by_depth);
+
+    //Compiled inference path
+    bytes += memory_usage::vector_bytes(this->compiled_kind) + memory_usage::vector_bytes(this->compiled_io_index);
+    bytes += memory_usage::vector_bytes(this->compiled_edge_start) + memory_usage::vector_bytes(this->compiled_edge_to);
+    bytes += memory_usage::vector_bytes(this->compiled_edge_weight) + memory_usage::vector_bytes(this->compiled_values);
+    bytes += memory_usage::vector_bytes(this->compiled_gene_edge);
+    bytes += this->hidden_func_str.capacity() + this->output_func_str.capacity();
+    if (this->substrate_network) bytes += this->substrate_network->get_memory_usage();
+    return bytes;
+}
+
+void Network::compact_memory(){
+    //Release spare capacity left over from mutation and compilation
+    this->connection_data.shrink_to_fit();
+    for (std::vector<float>& connection : this->connection_data) connection.shrink_to_fit();
+    this->temporary_depth_data.shrink_to_fit();
+    this->ordered_by_depth.shrink_to_fit();
+    this->compiled_kind.shrink_to_fit();
+    this->compiled_io_index.shrink_to_fit();
+    this->compiled_edge_start.shrink_to_fit();
+    this->compiled_edge_to.shrink_to_fit();
+    this->compiled_edge_weight.shrink_to_fit();
+    this->compiled_gene_edge.shrink_to_fit();
+    this->compiled_values.shrink_to_fit();
 }
\ No newline at end of file
@@ -1,8 +1,12 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
-#include "Neuron.h"
+#include "Random.h"
+#include "WorkerProtocol.h"
+#include "CompactGenome.h"
+#include "Substrate.h"
 #include <vector>
+#include <memory>
 #include <map>
 #include <string>
 #include <iostream>
@@ -17,11 +21,31 @@ namespace godot {
 struct Network {
     godot::NEATAgent* parent_agent = nullptr;
 
-    std::map<int, Neuron*> neurons;
     std::vector<int> ordered_by_depth; //Int is id of neuron
     std::vector<std::vector<float>> connection_data;
     std::vector<int> temporary_depth_data;
 
+    //Compact genome (see NEATAgent::set_compact_genomes). Once compacted, connection_data is only filled while materialized
+    std::shared_ptr<const PackedGenome> genome_base;
+    GenomeDelta genome_delta;
+    bool genome_compacted = false;
+    int enabled_gene_count = 0;
+
+    //Compiled inference path, holds only live neurons (see compile_live_network)
+    enum NeuronKind { KIND_INPUT, KIND_HIDDEN, KIND_OUTPUT };
+    std::vector<int> compiled_kind;
+    std::vector<int> compiled_io_index; //Input or output number, -1 for hidden
+    std::vector<int> compiled_edge_start; //Edges of slot i are compiled_edge_start[i] to compiled_edge_start[i+1]
+    std::vector<int> compiled_edge_to; //Slot index of the target neuron
+    std::vector<float> compiled_edge_weight;
+    std::vector<int> compiled_gene_edge; //Compiled edge of each gene in connection_data, -1 if it was not compiled
+    std::vector<float> compiled_values;
+    uint64_t topology_hash = 0; //Same for networks whose compiled path differs only in weights
+
+    //Substrate realized from this network as a CPPN (see NEATAgent::realize_substrate), built on first use
+    std::unique_ptr<SubstrateNetwork> substrate_network;
+    int substrate_version = -1;
+
     std::string hidden_func_str;
     std::string output_func_str;
 
@@ -29,25 +53,43 @@ struct Network {
     int outputs;
     float fitness = 0.0;
     float adjusted_fitness = 0.0;
+    std::vector<float> behavior; //Set by set_network_behavior when novelty search is on
+    float novelty = 0.0;
+    float novelty_score = 0.0; //Novelty rescaled to the population's fitness range
+    uint64_t genome_hash = 0; //Same for any two genomes with the same enabled connections and weights
+    bool fitness_cached = false;
 
 
-    void weight_mutation(std::mt19937 &gen);
-    void add_connection(std::mt19937 &gen);
-    void toggle_enable(std::mt19937 &gen);
-    void add_neuron(std::mt19937 &gen);
+    void weight_mutation(NEATRandom &gen);
+    void add_connection(NEATRandom &gen);
+    void toggle_enable(NEATRandom &gen);
+    void add_neuron(NEATRandom &gen);
 
     void build_network_structure();
+    void compile_live_network();
+    void clone_compiled_network(const Network* source);
+    void compute_genome_hash();
+    void compute_topology_hash();
+    bool same_topology(const Network* other) const;
 
-    Network(int inputs, int outputs, std::vector<int>* depth_data, std::vector<std::vector<float>>* connection_data, std::string h, std::string o, bool mutate, std::mt19937 &gen, godot::NEATAgent* parent_agent);
-    ~Network();
+    Network(int inputs, int outputs, std::vector<int>* depth_data, std::vector<std::vector<float>>* connection_data, std::string h, std::string o, bool mutate, NEATRandom &gen, godot::NEATAgent* parent_agent, const Network* structure_source = nullptr);
     
     std::vector<int>& get_depth_data();
     std::vector<std::vector<float>>& get_connection_data();
     
     float activation_func(float x, std::string type);
+    static int activation_code(const std::string &type);
+    worker_protocol::EncodedNetwork encode_compiled();
     std::vector<float> guess(std::vector<float> inputs);
     void connect_neurons(std::vector<std::vector<float>> *c, int first_id, int second_id, float weight);
     int get_active_connection_count();
+    int count_enabled_genes();
+    void compact_genome(const Network* parent_a, const Network* parent_b);
+    void release_genome();
+    void expand_genome();
+    size_t get_genome_memory_usage();
+    size_t get_phenotype_memory_usage();
+    void compact_memory();
 
 };
 
@@ -2,29 +2,27 @@
 #define NETWORKAGENT_H
 
 #include <vector>
-#include <map>
-#include <set>
+#include <memory>
 #include <string>
+#include "NetworkModel.h"
 #include <godot_cpp/classes/ref_counted.hpp>
 
 namespace godot {
     class NetworkAgent : public RefCounted {
         GDCLASS(NetworkAgent, RefCounted);
+        friend class ChampionLogReader;
+        friend class NEATModel;
     protected:
         static void _bind_methods();
     private:
-        int inputs = -1;
-        int outputs = -1;
-        int hidden_function = -1;
-        int output_function = -1;
+        //Shared with every agent and NEATModel built from the same network, only the scratch values belong to this agent
+        std::shared_ptr<const NetworkModel> model;
         std::vector<float> values;
-        std::vector<std::pair<std::pair<int, int>, float>> connections;
 
         void initialize_agent(Array network_data);
+        void set_model(std::shared_ptr<const NetworkModel> model);
         PackedFloat32Array guess(PackedFloat32Array inputs);
-        std::vector<float> packed_to_vector_float(const PackedFloat32Array &array);
-        PackedFloat32Array vector_to_packed_float(const std::vector<float> &vec);
-        float activation_func(float x, int type);
+        static bool parse_network_data(const Array &network_data, champion_log::Header &header, std::vector<champion_log::Connection> &connections);
     };
 };
 
@@ -0,0 +1,176 @@
+#include "NetworkModel.h"
+#include "CompiledNetwork.h"
+#include "Random.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    std::mutex cache_mutex;
+    std::unordered_map<uint64_t, std::vector<std::weak_ptr<const NetworkModel>>> cache;
+
+    uint64_t content_hash(const champion_log::Header &header, const std::vector<champion_log::Connection> &connections){
+        uint64_t hash = NEATRandom::mix(((uint64_t)header.inputs << 32) | header.outputs);
+        hash = NEATRandom::mix(hash ^ (((uint64_t)header.hidden_function << 32) | header.output_function));
+        for (const champion_log::Connection &connection : connections){
+            uint32_t weight_bits;
+            std::memcpy(&weight_bits, &connection.weight, sizeof(weight_bits));
+            hash = NEATRandom::mix(hash ^ (((uint64_t)connection.from << 32) | connection.to));
+            hash = NEATRandom::mix(hash ^ weight_bits);
+        }
+        return hash;
+    }
+}
+
+bool NetworkModel::same_network(const champion_log::Header &header, const std::vector<champion_log::Connection> &connections) const {
+    if (std::memcmp(&this->header, &header, sizeof(header)) != 0 || connections.size() != this->from.size()) return false;
+    for (int i = 0; i < connections.size(); i++){
+        if (connections[i].from != (uint32_t)this->from[i] || connections[i].to != (uint32_t)this->to[i]) return false;
+        if (std::memcmp(&connections[i].weight, &this->weight[i], sizeof(float)) != 0) return false;
+    }
+    return true;
+}
+
+void NetworkModel::evaluate(const float* inputs, float* outputs, float* values) const {
+    int input_count = (int)this->header.inputs;
+    std::fill(values, values + this->value_count, 0.0f);
+    for (int i = 0; i < input_count && i < this->value_count; i++) values[i] = inputs[i];
+
+    for (int e = 0; e < this->from.size(); e++){
+        int from = this->from[e];
+        if (this->activate_from[e]) values[from] = compiled_network::activation(values[from], (int32_t)this->header.hidden_function);
+        values[this->to[e]] += values[from] * this->weight[e];
+    }
+
+    for (int i = 0; i < (int)this->header.outputs; i++){
+        outputs[i] = compiled_network::activation(values[input_count + i], (int32_t)this->header.output_function);
+    }
+}
+
+size_t NetworkModel::get_memory_usage() const {
+    return sizeof(NetworkModel) + this->from.capacity() * sizeof(int32_t) + this->to.capacity() * sizeof(int32_t)
+         + this->weight.capacity() * sizeof(float) + this->activate_from.capacity() * sizeof(uint8_t);
+}
+
+std::shared_ptr<const NetworkModel> network_model::acquire(const champion_log::Header &header, const std::vector<champion_log::Connection> &connections){
+    uint64_t hash = content_hash(header, connections);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto found = cache.find(hash);
+        if (found != cache.end()){
+            for (const std::weak_ptr<const NetworkModel> &entry : found->second){
+                std::shared_ptr<const NetworkModel> model = entry.lock();
+                if (model && model->same_network(header, connections)) return model;
+            }
+        }
+    }
+
+    //Compile outside the lock, another thread may compile the same network meanwhile and the first one cached wins
+    std::shared_ptr<NetworkModel> model = std::make_shared<NetworkModel>();
+    model->header = header;
+    model->hash = hash;
+    model->value_count = (int)(header.inputs + header.outputs);
+    model->from.reserve(connections.size());
+    model->to.reserve(connections.size());
+    model->weight.reserve(connections.size());
+    model->activate_from.reserve(connections.size());
+
+    std::vector<uint8_t> visited;
+    for (const champion_log::Connection &connection : connections){
+        int from = (int)connection.from;
+        int to = (int)connection.to;
+        model->value_count = std::max(model->value_count, std::max(from, to) + 1);
+        if (visited.size() < model->value_count) visited.resize(model->value_count, 0);
+
+        bool activate = from >= (int)header.inputs && !visited[from];
+        if (activate) visited[from] = 1;
+
+        model->from.push_back(from);
+        model->to.push_back(to);
+        model->weight.push_back(connection.weight);
+        model->activate_from.push_back(activate);
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    std::vector<std::weak_ptr<const NetworkModel>> &entries = cache[hash];
+    for (int i = 0; i < entries.size(); i++){
+        std::shared_ptr<const NetworkModel> existing = entries[i].lock();
+        if (!existing){
+            entries.erase(entries.begin() + i);
+            i--;
+        }
+        else if (existing->same_network(header, connections)) return existing;
+    }
+    entries.push_back(model);
+
+    //Drop buckets whose models are all gone now and then so the map does not grow with every network ever loaded
+    if (cache.size() > 64 && (hash & 63) == 0){
+        for (auto it = cache.begin(); it != cache.end();){
+            bool alive = false;
+            for (const std::weak_ptr<const NetworkModel> &entry : it->second) alive = alive || !entry.expired();
+            it = alive ? std::next(it) : cache.erase(it);
+        }
+    }
+    return model;
+}
+
+int network_model::cached_model_count(){
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    int count = 0;
+    for (auto const& [hash, entries] : cache){
+        for (const std::weak_ptr<const NetworkModel> &entry : entries) count += !entry.expired();
+    }
+    return count;
+}
+
+void network_model::encode(const NetworkModel &model, std::vector<uint8_t> &out){
+    uint32_t fields[7] = {MAGIC, VERSION, model.header.inputs, model.header.outputs, model.header.hidden_function, model.header.output_function, (uint32_t)model.connection_count()};
+    out.resize(HEADER_SIZE + (size_t)model.connection_count() * sizeof(champion_log::Connection));
+    std::memcpy(out.data(), fields, HEADER_SIZE);
+
+    uint8_t* write = out.data() + HEADER_SIZE;
+    for (int i = 0; i < model.connection_count(); i++){
+        champion_log::Connection connection = {(uint32_t)model.from[i], (uint32_t)model.to[i], model.weight[i]};
+        std::memcpy(write, &connection, sizeof(connection));
+        write += sizeof(connection);
+    }
+}
+
+bool network_model::decode(const uint8_t* data, size_t size, champion_log::Header &header, std::vector<champion_log::Connection> &connections, std::string &error){
+    if (size < HEADER_SIZE){
+        error = "File is too small to be a model";
+        return false;
+    }
+    uint32_t fields[7];
+    std::memcpy(fields, data, HEADER_SIZE);
+    if (fields[0] != MAGIC){
+        error = "File is not a model";
+        return false;
+    }
+    if (fields[1] != VERSION){
+        error = "Unsupported model version " + std::to_string(fields[1]);
+        return false;
+    }
+    if (size != HEADER_SIZE + (size_t)fields[6] * sizeof(champion_log::Connection)){
+        error = "File size does not match its connection count";
+        return false;
+    }
+    if (fields[2] < 1 || fields[3] < 1 || fields[4] > 3 || fields[5] > 3){
+        error = "Header has invalid sizes or activation functions";
+        return false;
+    }
+
+    header = {fields[2], fields[3], fields[4], fields[5]};
+    connections.resize(fields[6]);
+    if (!connections.empty()) std::memcpy(connections.data(), data + HEADER_SIZE, connections.size() * sizeof(champion_log::Connection));
+    for (const champion_log::Connection &connection : connections){
+        if (connection.from > INT32_MAX - 1 || connection.to > INT32_MAX - 1){
+            error = "Connection neuron id is out of range";
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#ifndef NETWORKMODEL_H
+#define NETWORKMODEL_H
+
+#include "ChampionLog.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//Immutable compiled form of an exported network (the extract_champion_data layout). Models are shared by every NetworkAgent
+//built from the same network, an agent only owns its scratch values
+struct NetworkModel {
+    champion_log::Header header = {};
+    uint64_t hash = 0;
+    int value_count = 0; //Highest neuron id + 1
+
+    //Connections in their exported order, the order guess has always evaluated them in
+    std::vector<int32_t> from;
+    std::vector<int32_t> to;
+    std::vector<float> weight;
+    std::vector<uint8_t> activate_from; //First use of a hidden neuron as a source, its activation is applied there
+
+    int connection_count() const { return (int)this->from.size(); }
+    bool same_network(const champion_log::Header &header, const std::vector<champion_log::Connection> &connections) const;
+
+    //inputs must include the trailing bias input of 1.0, values needs value_count floats
+    void evaluate(const float* inputs, float* outputs, float* values) const;
+    size_t get_memory_usage() const;
+};
+
+//Model files (.neatmodel) are laid out as (all little endian):
+//  uint32 magic "NEMD" | uint32 version (1) | uint32 inputs | uint32 outputs | uint32 hidden_function | uint32 output_function
+//  uint32 connection_count | connection_count * (uint32 from, uint32 to, float32 weight)
+//Connections use the champion log layout
+namespace network_model {
+    const uint32_t MAGIC = 0x444D454E; //"NEMD"
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = 7 * sizeof(uint32_t);
+
+    //Returns the cached model with this content or compiles and caches a new one. The cache only holds weak references,
+    //so a model is freed once the last agent and resource using it are gone
+    std::shared_ptr<const NetworkModel> acquire(const champion_log::Header &header, const std::vector<champion_log::Connection> &connections);
+    int cached_model_count();
+
+    void encode(const NetworkModel &model, std::vector<uint8_t> &out);
+    bool decode(const uint8_t* data, size_t size, champion_log::Header &header, std::vector<champion_log::Connection> &connections, std::string &error);
+}
+
+#endif
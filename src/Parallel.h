@@ -0,0 +1,33 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+//Runs fn(i) for every i in [0, count) on up to thread_count threads (0 or less means one per hardware thread).
+//Indices are handed out one at a time so uneven work still balances. With one thread everything runs inline, which keeps
+//platforms without threads (web exports) working
+template <typename F>
+void parallel_for(int count, int thread_count, F fn){
+    if (thread_count <= 0) thread_count = std::thread::hardware_concurrency();
+    if (thread_count > count) thread_count = count;
+
+    if (thread_count <= 1){
+        for (int i = 0; i < count; i++) fn(i);
+        return;
+    }
+
+    std::atomic<int> next_index(0);
+    auto worker = [&next_index, count, &fn]() {
+        for (int i = next_index++; i < count; i = next_index++) fn(i);
+    };
+
+    //Calling thread works too
+    std::vector<std::thread> threads;
+    for (int t = 1; t < thread_count; t++) threads.emplace_back(worker);
+    worker();
+    for (std::thread &thread : threads) thread.join();
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+//Layer tables for NEATRandom::normal, the 128 layer ziggurat of Marsaglia and Tsang
+struct ZigguratTables {
+    uint32_t k[128];
+    float w[128];
+    float f[128];
+
+    ZigguratTables() {
+        const double m = 2147483648.0;
+        const double v = 9.91256303526217e-3;
+        double d = 3.442619855899;
+        double t = d;
+        double q = v / std::exp(-0.5 * d * d);
+
+        this->k[0] = (uint32_t)((d / q) * m);
+        this->k[1] = 0;
+        this->w[0] = (float)(q / m);
+        this->w[127] = (float)(d / m);
+        this->f[0] = 1.0f;
+        this->f[127] = (float)std::exp(-0.5 * d * d);
+        for (int i = 126; i >= 1; i--){
+            d = std::sqrt(-2.0 * std::log(v / d + std::exp(-0.5 * d * d)));
+            this->k[i + 1] = (uint32_t)((d / t) * m);
+            t = d;
+            this->f[i] = (float)std::exp(-0.5 * d * d);
+            this->w[i] = (float)(d / m);
+        }
+    }
+
+    static const ZigguratTables& get() {
+        static const ZigguratTables tables;
+        return tables;
+    }
+
+    static constexpr double R = 3.442619855899; //Start of the tail
+};
+
+//Counter based generator built on the SplitMix64 mixer. Every output is a pure function of (key, counter), so the
+//state is 16 bytes and independent streams can be derived for any generation and network without sharing state.
+//Satisfies UniformRandomBitGenerator so it works with the std distributions
+struct NEATRandom {
+    typedef uint64_t result_type;
+
+    uint64_t key = 0;
+    uint64_t counter = 0;
+
+    NEATRandom() {}
+    explicit NEATRandom(uint64_t seed) : key(mix(seed)) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint64_t>::max(); }
+
+    result_type operator()() {
+        return mix(this->key + (++this->counter) * GOLDEN_GAMMA);
+    }
+
+    //Uniform float in [0, 1) from the top 24 bits, cheaper than std::uniform_real_distribution
+    float uniform() {
+        return (float)((*this)() >> 40) * (1.0f / 16777216.0f);
+    }
+
+    //count draws at once, the same values as count calls to operator(). Each value depends only on its counter, so the loop vectorizes
+    void fill(uint64_t* out, int count) {
+        uint64_t base = this->counter;
+        for (int i = 0; i < count; i++) out[i] = mix(this->key + (base + 1 + i) * GOLDEN_GAMMA);
+        this->counter += count;
+    }
+
+    //Standard normal deviate. About 99% of draws take one value, a table lookup and a compare
+    float normal() {
+        uint64_t bits = (*this)();
+        return normal_from(bits, ZigguratTables::get());
+    }
+
+    //count normals at once, for bulk mutation
+    void fill_normal(float* out, int count) {
+        const ZigguratTables &tables = ZigguratTables::get();
+        uint64_t base = this->counter;
+        this->counter += count;
+        for (int i = 0; i < count; i++) out[i] = normal_from(mix(this->key + (base + 1 + i) * GOLDEN_GAMMA), tables);
+    }
+
+    //Stream for (generation, index). Use -1 for either to name a stream that isnt tied to one generation or network
+    NEATRandom stream(int64_t generation, int64_t index) const {
+        NEATRandom derived;
+        derived.key = mix(this->key ^ mix((uint64_t)generation + GOLDEN_GAMMA) ^ mix(mix((uint64_t)index) + 2 * GOLDEN_GAMMA));
+        return derived;
+    }
+
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    static const uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+private:
+    //Signed 32 bit position from the high half, layer from the low bits
+    float normal_from(uint64_t bits, const ZigguratTables &tables) {
+        int32_t position = (int32_t)(uint32_t)(bits >> 32);
+        int layer = (int)(bits & 127);
+        uint32_t magnitude = position < 0 ? (uint32_t)0 - (uint32_t)position : (uint32_t)position;
+        if (magnitude < tables.k[layer]) return (float)position * tables.w[layer];
+        return normal_slow(position, layer, tables);
+    }
+
+    float normal_slow(int32_t position, int layer, const ZigguratTables &tables) {
+        while (true){
+            float x = (float)position * tables.w[layer];
+
+            //Base layer, sample the tail past R
+            if (layer == 0){
+                float tail_x, tail_y;
+                do {
+                    tail_x = -std::log(uniform_open()) / (float)ZigguratTables::R;
+                    tail_y = -std::log(uniform_open());
+                } while (tail_y + tail_y < tail_x * tail_x);
+                return (position > 0) ? (float)ZigguratTables::R + tail_x : -(float)ZigguratTables::R - tail_x;
+            }
+
+            //Wedge between this layer and the one below
+            if (tables.f[layer] + uniform() * (tables.f[layer - 1] - tables.f[layer]) < std::exp(-0.5f * x * x)) return x;
+
+            uint64_t bits = (*this)();
+            position = (int32_t)(uint32_t)(bits >> 32);
+            layer = (int)(bits & 127);
+            uint32_t magnitude = position < 0 ? (uint32_t)0 - (uint32_t)position : (uint32_t)position;
+            if (magnitude < tables.k[layer]) return (float)position * tables.w[layer];
+        }
+    }
+
+    //Uniform float in (0, 1], safe to take the log of
+    float uniform_open() {
+        return (float)(((*this)() >> 40) + 1) * (1.0f / 16777216.0f);
+    }
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "ReplayLog.h"
+#include <cstring>
+
+template <typename T>
+static void put(std::vector<uint8_t> &out, const T &value){
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+static T get(const std::vector<uint8_t> &bytes, size_t offset){
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+uint32_t ReplayLogFile::read_u32(size_t offset) const {
+    return get<uint32_t>(this->bytes, offset);
+}
+
+bool ReplayLogFile::read_file(const std::string &path){
+    this->bytes.clear();
+    this->offsets.clear();
+    this->genesis = replay_log::Genesis();
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr){
+        this->last_error = "Could not open replay log " + path;
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size > 0){
+        this->bytes.resize(size);
+        if (fread(this->bytes.data(), 1, size, file) != (size_t)size) this->bytes.clear();
+    }
+    fclose(file);
+
+    if (this->bytes.size() < replay_log::HEADER_SIZE){
+        this->last_error = "Replay log is too small to hold a header";
+        return false;
+    }
+    if (read_u32(0) != replay_log::MAGIC || read_u32(4) != replay_log::VERSION){
+        this->last_error = "Replay log has the wrong magic or version";
+        return false;
+    }
+
+    replay_log::Genesis &genesis = this->genesis;
+    genesis.seed = get<uint64_t>(this->bytes, 8);
+    genesis.kind = read_u32(16);
+    genesis.inputs = read_u32(20);
+    genesis.outputs = read_u32(24);
+    genesis.population_size = read_u32(28);
+    genesis.species_count = read_u32(32);
+    genesis.hidden_function = read_u32(36);
+    genesis.output_function = read_u32(40);
+    genesis.initial_enabled_percent = get<float>(this->bytes, 44);
+    size_t template_count = read_u32(48);
+    size_t offset = replay_log::HEADER_SIZE + template_count * sizeof(champion_log::Connection);
+    if (offset > this->bytes.size()){
+        this->last_error = "Replay log header is cut short";
+        return false;
+    }
+    genesis.template_connections.resize(template_count);
+    if (template_count > 0) std::memcpy(genesis.template_connections.data(), this->bytes.data() + replay_log::HEADER_SIZE, template_count * sizeof(champion_log::Connection));
+
+    //Same walk as the champion log, stopping at the first record that doesnt add up or runs past the end of the file
+    while (offset + replay_log::RECORD_HEADER_SIZE <= this->bytes.size()){
+        size_t record_size = read_u32(offset);
+        size_t network_count = read_u32(offset + replay_log::RECORD_HEADER_SIZE - 4);
+        if (record_size != replay_log::RECORD_HEADER_SIZE + network_count * sizeof(float) || offset + record_size > this->bytes.size()) break;
+        this->offsets.push_back(offset);
+        offset += record_size;
+    }
+    return true;
+}
+
+void ReplayLogFile::read_record(int record, replay_log::Generation &out) const {
+    size_t offset = this->offsets[record];
+    out.generation = read_u32(offset + 4);
+    out.flags = read_u32(offset + 8);
+    out.seed = get<uint64_t>(this->bytes, offset + 12);
+    std::memcpy(&out.settings, this->bytes.data() + offset + 20, sizeof(out.settings));
+    out.innovation_counter = read_u32(offset + 60);
+    out.neuron_counter = read_u32(offset + 64);
+    out.population_hash = get<uint64_t>(this->bytes, offset + 68);
+    out.fitness.resize(read_u32(offset + 76));
+    if (!out.fitness.empty()) std::memcpy(out.fitness.data(), this->bytes.data() + offset + replay_log::RECORD_HEADER_SIZE, out.fitness.size() * sizeof(float));
+}
+
+ReplayLogWriter::~ReplayLogWriter(){
+    close();
+}
+
+bool ReplayLogWriter::open(const std::string &path, const replay_log::Genesis &genesis){
+    close();
+
+    this->file = fopen(path.c_str(), "wb");
+    if (this->file == nullptr){
+        this->last_error = "Could not open " + path + " for writing";
+        return false;
+    }
+
+    std::vector<uint8_t> header;
+    put(header, replay_log::MAGIC);
+    put(header, replay_log::VERSION);
+    put(header, genesis.seed);
+    put(header, genesis.kind);
+    put(header, genesis.inputs);
+    put(header, genesis.outputs);
+    put(header, genesis.population_size);
+    put(header, genesis.species_count);
+    put(header, genesis.hidden_function);
+    put(header, genesis.output_function);
+    put(header, genesis.initial_enabled_percent);
+    put(header, (uint32_t)genesis.template_connections.size());
+    for (const champion_log::Connection &connection : genesis.template_connections) put(header, connection);
+
+    if (fwrite(header.data(), header.size(), 1, this->file) != 1){
+        close();
+        this->last_error = "Could not write the replay log header to " + path;
+        return false;
+    }
+    fflush(this->file);
+    return true;
+}
+
+void ReplayLogWriter::append(const replay_log::Generation &record){
+    if (this->file == nullptr) return;
+
+    std::vector<uint8_t> &bytes = this->record_scratch;
+    bytes.clear();
+    put(bytes, (uint32_t)(replay_log::RECORD_HEADER_SIZE + record.fitness.size() * sizeof(float)));
+    put(bytes, record.generation);
+    put(bytes, record.flags);
+    put(bytes, record.seed);
+    put(bytes, record.settings);
+    put(bytes, record.innovation_counter);
+    put(bytes, record.neuron_counter);
+    put(bytes, record.population_hash);
+    put(bytes, (uint32_t)record.fitness.size());
+    for (float fitness : record.fitness) put(bytes, fitness);
+
+    //Whole records only, flushed so a crash loses at most the generation being written
+    fwrite(bytes.data(), bytes.size(), 1, this->file);
+    fflush(this->file);
+}
+
+void ReplayLogWriter::close(){
+    if (this->file != nullptr) fclose(this->file);
+    this->file = nullptr;
+}
@@ -0,0 +1,108 @@
+#ifndef REPLAYLOG_H
+#define REPLAYLOG_H
+
+#include "ChampionLog.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//Everything needed to rebuild any generation of a run (see NEATAgent.start_replay_log). Every random draw comes from the seed and
+//the generation (see NEATAgent.network_stream), so the starting population, the settings and the fitness each generation was
+//bred from are enough. Laid out as (all little endian):
+//  header: uint32 magic "NERL" | uint32 version (1) | uint64 seed | uint32 genesis | uint32 inputs | uint32 outputs | uint32 population_size
+//          | uint32 species_count | uint32 hidden_function | uint32 output_function | float32 initial_enabled_percent
+//          | uint32 template_connection_count | template_connection_count * (uint32 from, uint32 to, float32 weight)
+//  record: uint32 record_size | uint32 generation | uint32 flags | uint64 seed | 4 * float32 mutation rates | 6 * int32 settings
+//          | uint32 innovation_counter | uint32 neuron_counter | uint64 population_hash | uint32 network_count | network_count * float32 fitness
+//Flags are events since the previous record that the settings dont cover. The counters and hash are taken after the generation and
+//only check the replay, a record cut short by a crash is dropped like in the champion log
+namespace replay_log {
+    const uint32_t MAGIC = 0x4C52454E; //"NERL"
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = 13 * sizeof(uint32_t);
+    const size_t RECORD_HEADER_SIZE = 16 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+    enum GenesisKind : uint32_t { GENESIS_INITIALIZE = 0, GENESIS_TEMPLATE = 1 };
+
+    enum Flags : uint32_t {
+        FLAG_CHAMPION_RESET = 1,        //force_champion_reset was called
+        FLAG_INNOVATIONS_COMPACTED = 2, //The memory budget forgot unused innovations
+        FLAG_GROWTH_BLOCKED = 4,        //The memory budget blocked new neurons and connections for this generation
+        FLAG_SPECIES_INDEX = 8,
+    };
+
+    //How the first population was made. inputs is as passed to initialize_population (without the bias) for GENESIS_INITIALIZE,
+    //and as stored in the template (with the bias) for GENESIS_TEMPLATE
+    struct Genesis {
+        uint64_t seed = 0;
+        uint32_t kind = GENESIS_INITIALIZE;
+        uint32_t inputs = 0;
+        uint32_t outputs = 0;
+        uint32_t population_size = 0;
+        uint32_t species_count = 0;
+        uint32_t hidden_function = 0;
+        uint32_t output_function = 0;
+        float initial_enabled_percent = 0.0f;
+        std::vector<champion_log::Connection> template_connections;
+    };
+
+    struct Settings {
+        float rate_weight_mutate;
+        float rate_connection_mutate;
+        float rate_enable_mutate;
+        float rate_node_mutate;
+        int32_t size_cap;
+        int32_t stagnation_limit;
+        int32_t selection_mode;
+        int32_t tournament_size;
+        int32_t species_index_bands;
+        int32_t species_index_rows;
+    };
+    static_assert(sizeof(Settings) == 40, "Settings are stored as ten 4 byte fields");
+
+    struct Generation {
+        uint32_t generation = 0;
+        uint32_t flags = 0;
+        uint64_t seed = 0; //set_seed can change it between generations
+        Settings settings = {};
+        uint32_t innovation_counter = 0;
+        uint32_t neuron_counter = 0;
+        uint64_t population_hash = 0;
+        std::vector<float> fitness;
+    };
+}
+
+//Whole log read into memory, it is a few kilobytes per generation. Records are decoded when asked for
+struct ReplayLogFile {
+    replay_log::Genesis genesis;
+    std::string last_error;
+
+    bool read_file(const std::string &path);
+    int record_count() const { return (int)this->offsets.size(); }
+    void read_record(int record, replay_log::Generation &out) const;
+
+private:
+    std::vector<uint8_t> bytes;
+    std::vector<size_t> offsets;
+    uint32_t read_u32(size_t offset) const;
+};
+
+//Records are small, so they are written and flushed on the calling thread as each generation finishes
+struct ReplayLogWriter {
+    std::string last_error;
+
+    bool open(const std::string &path, const replay_log::Genesis &genesis); //Always starts a new log
+    void append(const replay_log::Generation &record);
+    void close();
+    bool is_open() const { return this->file != nullptr; }
+
+    ~ReplayLogWriter();
+
+private:
+    FILE* file = nullptr;
+    std::vector<uint8_t> record_scratch;
+};
+
+#endif
@@ -0,0 +1,184 @@
+#include "SharedPopulation.h"
+#include "Network.h"
+#include <cstring>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared population sequence counter must be lock free");
+
+SharedPopulationWriter::~SharedPopulationWriter(){
+    close();
+}
+
+bool SharedPopulationWriter::is_open(){
+    return this->base != nullptr;
+}
+
+#ifdef _WIN32
+
+bool SharedPopulationWriter::open(const std::string &name){
+    this->last_error = "Shared memory export is not supported on this platform";
+    return false;
+}
+
+void SharedPopulationWriter::close(){}
+
+bool SharedPopulationWriter::publish(uint64_t generation, const std::vector<Network*> &networks){
+    return false;
+}
+
+bool SharedPopulationWriter::read_results(std::vector<float> &fitness){
+    return false;
+}
+
+bool SharedPopulationWriter::ensure_size(size_t size){
+    return false;
+}
+
+#else
+
+bool SharedPopulationWriter::open(const std::string &name){
+    close();
+
+    int new_fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (new_fd < 0){
+        this->last_error = "Could not create shared memory " + name;
+        return false;
+    }
+
+    this->name = name;
+    this->fd = new_fd;
+    return ensure_size(sizeof(shared_population::Header));
+}
+
+void SharedPopulationWriter::close(){
+    if (this->base != nullptr) munmap(this->base, this->mapped_size);
+    if (this->fd >= 0){
+        ::close(this->fd);
+        shm_unlink(this->name.c_str());
+    }
+    this->base = nullptr;
+    this->mapped_size = 0;
+    this->fd = -1;
+}
+
+bool SharedPopulationWriter::ensure_size(size_t size){
+    if (size <= this->mapped_size) return true;
+
+    //Grow with headroom so a slowly growing population doesnt remap every generation
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t new_size = ((size + size / 2) + page - 1) / page * page;
+
+    if (ftruncate(this->fd, new_size) != 0){
+        this->last_error = "Could not resize shared memory " + this->name;
+        return false;
+    }
+    if (this->base != nullptr) munmap(this->base, this->mapped_size);
+
+    void* mapped = mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+    if (mapped == MAP_FAILED){
+        this->base = nullptr;
+        this->mapped_size = 0;
+        this->last_error = "Could not map shared memory " + this->name;
+        return false;
+    }
+    this->base = (uint8_t*)mapped;
+    this->mapped_size = new_size;
+    return true;
+}
+
+bool SharedPopulationWriter::publish(uint64_t generation, const std::vector<Network*> &networks){
+    using namespace shared_population;
+    if (this->fd < 0) return false;
+
+    //Size every section
+    uint64_t node_total = 0;
+    uint64_t edge_total = 0;
+    for (Network* n : networks){
+        node_total += n->compiled_kind.size();
+        edge_total += n->compiled_edge_to.size();
+    }
+
+    uint64_t count = networks.size();
+    uint64_t index_offset = sizeof(Header);
+    uint64_t kind_offset = index_offset + count * sizeof(IndexEntry);
+    uint64_t io_index_offset = kind_offset + node_total * sizeof(int32_t);
+    uint64_t edge_start_offset = io_index_offset + node_total * sizeof(int32_t);
+    uint64_t edge_to_offset = edge_start_offset + (node_total + count) * sizeof(int32_t);
+    uint64_t weight_offset = edge_to_offset + edge_total * sizeof(int32_t);
+    uint64_t page = sysconf(_SC_PAGESIZE);
+    uint64_t results_offset = (weight_offset + edge_total * sizeof(float) + page - 1) / page * page;
+    uint64_t total_size = results_offset + count * sizeof(float);
+
+    //Readers may still have the old layout mapped, so mark the region as being written first
+    bool had_mapping = this->base != nullptr;
+    if (had_mapping) ((Header*)this->base)->sequence.fetch_add(1, std::memory_order_acq_rel);
+    if (!ensure_size(total_size)) return false;
+
+    Header* header = (Header*)this->base;
+    if (!had_mapping) header->sequence.store(1, std::memory_order_release);
+
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->generation = generation;
+    header->total_size = this->mapped_size;
+    header->network_count = count;
+    header->inputs = networks.empty() ? 0 : networks[0]->inputs;
+    header->outputs = networks.empty() ? 0 : networks[0]->outputs;
+    header->hidden_function = networks.empty() ? -1 : Network::activation_code(networks[0]->hidden_func_str);
+    header->output_function = networks.empty() ? -1 : Network::activation_code(networks[0]->output_func_str);
+    header->reserved = 0;
+    header->index_offset = index_offset;
+    header->kind_offset = kind_offset;
+    header->io_index_offset = io_index_offset;
+    header->edge_start_offset = edge_start_offset;
+    header->edge_to_offset = edge_to_offset;
+    header->weight_offset = weight_offset;
+    header->results_offset = results_offset;
+
+    IndexEntry* index = (IndexEntry*)(this->base + index_offset);
+    int32_t* kinds = (int32_t*)(this->base + kind_offset);
+    int32_t* io_indices = (int32_t*)(this->base + io_index_offset);
+    int32_t* edge_starts = (int32_t*)(this->base + edge_start_offset);
+    int32_t* edge_tos = (int32_t*)(this->base + edge_to_offset);
+    float* weights = (float*)(this->base + weight_offset);
+
+    uint32_t node_offset = 0;
+    uint32_t edge_offset = 0;
+    for (uint64_t i = 0; i < count; i++){
+        Network* n = networks[i];
+        uint32_t nodes = n->compiled_kind.size();
+        uint32_t edges = n->compiled_edge_to.size();
+
+        index[i] = {node_offset, nodes, (uint32_t)(node_offset + i), edge_offset, edges};
+        memcpy(kinds + node_offset, n->compiled_kind.data(), nodes * sizeof(int32_t));
+        memcpy(io_indices + node_offset, n->compiled_io_index.data(), nodes * sizeof(int32_t));
+        memcpy(edge_starts + node_offset + i, n->compiled_edge_start.data(), (nodes + 1) * sizeof(int32_t));
+        memcpy(edge_tos + edge_offset, n->compiled_edge_to.data(), edges * sizeof(int32_t));
+        memcpy(weights + edge_offset, n->compiled_edge_weight.data(), edges * sizeof(float));
+
+        node_offset += nodes;
+        edge_offset += edges;
+    }
+
+    memset(this->base + results_offset, 0, count * sizeof(float));
+
+    header->sequence.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+bool SharedPopulationWriter::read_results(std::vector<float> &fitness){
+    if (this->base == nullptr) return false;
+    const shared_population::Header* header = (const shared_population::Header*)this->base;
+
+    const float* results = (const float*)(this->base + header->results_offset);
+    fitness.assign(results, results + header->network_count);
+    return true;
+}
+
+#endif
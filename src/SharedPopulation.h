@@ -0,0 +1,90 @@
+#ifndef SHAREDPOPULATION_H
+#define SHAREDPOPULATION_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "CompiledNetwork.h"
+
+class Network;
+
+//Layout of the shared memory region NEATAgent.publish_population_shared_memory writes. The layout part is plain C++ so
+//external programs can include this header, shm_open the name read only and run inference with no copies:
+//  Header | IndexEntry[network_count] | int32 kind[] | int32 io_index[] | int32 edge_start[] | int32 edge_to[] | float weight[] | (page aligned) float fitness[network_count]
+//Only the fitness array (from results_offset on) is meant to be mapped writable by readers. The host zeroes it on every publish
+//and read_shared_fitness takes any value above 0.0001.
+//Header.sequence is odd while the host is writing, so readers check it is even and unchanged around anything they read,
+//and only write fitness while the sequence still matches the networks they evaluated.
+//If total_size grows past what a reader mapped it must map the region again
+namespace shared_population {
+    const uint32_t MAGIC = 0x5341454E; //"NEAS"
+    const uint32_t VERSION = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        std::atomic<uint64_t> sequence;
+        uint64_t generation;
+        uint64_t total_size;
+        uint32_t network_count;
+        uint32_t inputs; //Including the bias input
+        uint32_t outputs;
+        int32_t hidden_function;
+        int32_t output_function;
+        uint32_t reserved;
+        uint64_t index_offset;
+        uint64_t kind_offset;
+        uint64_t io_index_offset;
+        uint64_t edge_start_offset;
+        uint64_t edge_to_offset;
+        uint64_t weight_offset;
+        uint64_t results_offset;
+    };
+
+    //Where one network lives in the node and edge arrays. edge_start and edge_to values are relative to the network
+    struct IndexEntry {
+        uint32_t node_offset;
+        uint32_t node_count;
+        uint32_t edge_start_offset; //node_count + 1 entries
+        uint32_t edge_offset;
+        uint32_t edge_count;
+    };
+
+    //Runs network number index of a mapped region. scratch needs the network's node_count floats
+    inline void evaluate(const uint8_t* base, uint32_t index, const float* inputs, float* outputs, float* scratch){
+        const Header* header = (const Header*)base;
+        const IndexEntry &entry = ((const IndexEntry*)(base + header->index_offset))[index];
+        compiled_network::evaluate(entry.node_count,
+                                   (const int32_t*)(base + header->kind_offset) + entry.node_offset,
+                                   (const int32_t*)(base + header->io_index_offset) + entry.node_offset,
+                                   (const int32_t*)(base + header->edge_start_offset) + entry.edge_start_offset,
+                                   (const int32_t*)(base + header->edge_to_offset) + entry.edge_offset,
+                                   (const float*)(base + header->weight_offset) + entry.edge_offset,
+                                   header->outputs, header->hidden_function, header->output_function, inputs, outputs, scratch);
+    }
+}
+
+//Host side writer, POSIX shared memory only
+struct SharedPopulationWriter {
+    std::string name;
+    int fd = -1;
+    uint8_t* base = nullptr;
+    size_t mapped_size = 0;
+    std::string last_error;
+
+    bool open(const std::string &name);
+    void close();
+    bool is_open();
+    bool publish(uint64_t generation, const std::vector<Network*> &networks);
+    //Copies the fitness array. Returns false if nothing is published
+    bool read_results(std::vector<float> &fitness);
+
+    ~SharedPopulationWriter();
+
+private:
+    bool ensure_size(size_t size);
+};
+
+#endif
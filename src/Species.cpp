@@ -1,17 +1,22 @@
 #include "Species.h"
 #include "Network.h"
+#include "MemoryUsage.h"
 
 void Species::add_member(Network* network){
     this->size++;
     this->networks.push_back(network);
 }
 
-void Species::sort_networks() {
+void Species::sort_networks() { //NOTE: Within a species adjusted fitness orders the same as fitness unless novelty is blended in
     std::sort(this->networks.begin(), this->networks.end(), [](Network* a, Network* b) {
-        return a->fitness > b->fitness;
+        return a->adjusted_fitness > b->adjusted_fitness;
     });
 }
 
+size_t Species::get_memory_usage(){
+    return sizeof(Species) + memory_usage::vector_bytes(this->networks) + memory_usage::nested_vector_bytes(this->representative_genome) + this->parent_table.get_memory_usage();
+}
+
 float Species::evaluate_compatibility(Network* candidate){
     //Set coefficient values
     float c1 = 1.0;
@@ -81,7 +86,7 @@ float Species::evaluate_compatibility(Network* candidate){
     return term1 + term2 + term3;
 }
 
-Network* Species::perform_crossover(Network* netA, Network* netB, std::mt19937 &gen){
+Network* Species::perform_crossover(Network* netA, Network* netB, NEATRandom &gen){
     std::vector<std::vector<float>> new_connection_data;
 
     std::uniform_real_distribution<float> dis(0.0, 1.0);
@@ -102,13 +107,13 @@ Network* Species::perform_crossover(Network* netA, Network* netB, std::mt19937 &
     std::map<int, float> less_fit_data;
 
     //Fill less fit parent data with the innov num and weight pair
-    for (std::vector<float> connection: less_fit->connection_data){
+    for (std::vector<float> connection: less_fit->get_connection_data()){
         float innov_num = connection[4];
         float weight = connection[2];
         less_fit_data.insert({(int)innov_num, weight});
     }
     //Cycle through more fit parent connectoin data
-    for (std::vector<float> connection: more_fit->connection_data){
+    for (std::vector<float> connection: more_fit->get_connection_data()){
         float innov_num = connection[4];
         float weight = connection[2];
         //Exists in prev_data so matching gene
@@ -129,5 +134,5 @@ Network* Species::perform_crossover(Network* netA, Network* netB, std::mt19937 &
     }
 
     //Create and return the new child network
-    return new Network(netA->inputs, netA->outputs, &more_fit->get_depth_data(), &new_connection_data, netA->hidden_func_str, netA->output_func_str, true, gen, netA->parent_agent);
+    return new Network(netA->inputs, netA->outputs, &more_fit->get_depth_data(), &new_connection_data, netA->hidden_func_str, netA->output_func_str, true, gen, netA->parent_agent, more_fit);
 }
\ No newline at end of file
@@ -6,22 +6,27 @@
 #include <map>
 #include <algorithm>
 #include <random>
+#include "Random.h"
+#include "AliasTable.h"
 
 
 class Network;
 
 struct Species {
     int size = 0;
+    int member_count = 0; //Members at the last fitness adjustment, size only ever grows
     int age = 0;
     int offspring_count = 0;
     int gens_since_improved = 0;
     float max_fitness_ever = 0.0f;
     std::vector<Network*> networks;
     std::vector<std::vector<float>> representative_genome;
+    AliasTable parent_table; //Over networks after culling, only built for rank and proportional selection
 
     void add_member(Network* network);
     void sort_networks();
+    size_t get_memory_usage();
     float evaluate_compatibility(Network* network);
-    static Network* perform_crossover(Network* netA, Network* netB, std::mt19937 &gen);
+    static Network* perform_crossover(Network* netA, Network* netB, NEATRandom &gen);
 };
 #endif
\ No newline at end of file
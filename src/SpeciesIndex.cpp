@@ -0,0 +1,72 @@
+#include "SpeciesIndex.h"
+#include "Random.h"
+#include <algorithm>
+#include <limits>
+
+void SpeciesIndex::configure(int bands, int rows){
+    this->bands = bands;
+    this->rows = rows;
+    clear();
+}
+
+void SpeciesIndex::clear(){
+    this->buckets.assign(this->bands, std::unordered_map<uint64_t, std::vector<int>>());
+    this->ignored.clear();
+}
+
+void SpeciesIndex::ignore_shared_innovations(const std::vector<const std::vector<std::vector<float>>*> &representatives){
+    this->ignored.clear();
+    if (representatives.size() < 2) return;
+
+    //Innovation -> (genomes seen in, last genome counted) so repeated genes in one genome only count once
+    std::unordered_map<int, std::pair<int, int>> seen;
+    for (int g = 0; g < representatives.size(); g++){
+        for (const std::vector<float> &gene : *representatives[g]){
+            std::pair<int, int> &entry = seen.try_emplace((int)gene[4], 0, -1).first->second;
+            if (entry.second == g) continue;
+            entry.first++;
+            entry.second = g;
+        }
+    }
+    for (auto const& [innovation, entry] : seen){
+        if (entry.first == representatives.size()) this->ignored.insert(innovation);
+    }
+}
+
+void SpeciesIndex::signature(const std::vector<std::vector<float>> &genes, std::vector<uint64_t> &out) const {
+    //Hash function j is mix(innovation ^ seed_j), seeds are fixed so signatures compare across generations
+    int hash_count = this->bands * this->rows;
+    out.assign(hash_count, std::numeric_limits<uint64_t>::max());
+    auto add = [this, hash_count, &out](int64_t element) {
+        uint64_t element_hash = NEATRandom::mix((uint64_t)element);
+        for (int j = 0; j < hash_count; j++){
+            uint64_t hashed = NEATRandom::mix(element_hash ^ ((uint64_t)(j + 1) * NEATRandom::GOLDEN_GAMMA));
+            if (hashed < out[j]) out[j] = hashed;
+        }
+    };
+
+    add(-1); //Sentinel
+    for (const std::vector<float> &gene : genes){
+        if (!this->ignored.count((int)gene[4])) add((int64_t)gene[4]);
+    }
+}
+
+uint64_t SpeciesIndex::band_key(const std::vector<uint64_t> &signature, int band) const {
+    uint64_t key = 0;
+    for (int r = 0; r < this->rows; r++) key = NEATRandom::mix(key ^ signature[band * this->rows + r]);
+    return key;
+}
+
+void SpeciesIndex::insert(int species_index, const std::vector<uint64_t> &signature){
+    for (int b = 0; b < this->bands; b++) this->buckets[b][band_key(signature, b)].push_back(species_index);
+}
+
+void SpeciesIndex::candidates(const std::vector<uint64_t> &signature, std::vector<int> &out) const {
+    out.clear();
+    for (int b = 0; b < this->bands; b++){
+        auto found = this->buckets[b].find(band_key(signature, b));
+        if (found != this->buckets[b].end()) out.insert(out.end(), found->second.begin(), found->second.end());
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
@@ -0,0 +1,34 @@
+#ifndef SPECIESINDEX_H
+#define SPECIESINDEX_H
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
+//Locality sensitive index over species representatives. Each genome's innovation set gets a MinHash signature of
+//bands * rows hashes, and every band of rows hashes is bucketed. Species sharing a bucket with a network in any band are its
+//candidates, so a network only runs the exact compatibility check against species with a similar innovation set.
+//Two genomes with Jaccard similarity J share a bucket with probability 1 - (1 - J^rows)^bands.
+//Compatibility only counts the genes two genomes dont share, so innovations every representative carries (the initial
+//template connections) are left out of the sets. Otherwise they push every pair's similarity towards 1. A sentinel element
+//keeps a genome with nothing but shared genes close to genomes with only a few genes of their own
+struct SpeciesIndex {
+    int bands = 16;
+    int rows = 2;
+
+    void configure(int bands, int rows);
+    void clear();
+    void ignore_shared_innovations(const std::vector<const std::vector<std::vector<float>>*> &representatives);
+    void signature(const std::vector<std::vector<float>> &genes, std::vector<uint64_t> &out) const;
+    void insert(int species_index, const std::vector<uint64_t> &signature);
+    //Candidate species in ascending index order, so first fit keeps the same preference order as a full scan
+    void candidates(const std::vector<uint64_t> &signature, std::vector<int> &out) const;
+
+private:
+    std::unordered_set<int> ignored;
+    std::vector<std::unordered_map<uint64_t, std::vector<int>>> buckets; //One table per band
+    uint64_t band_key(const std::vector<uint64_t> &signature, int band) const;
+};
+
+#endif
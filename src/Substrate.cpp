@@ -0,0 +1,124 @@
+#include "Substrate.h"
+#include "Network.h"
+#include "CompiledNetwork.h"
+#include "MemoryUsage.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+
+//Queries per CPPN batch, large enough to fill vector lanes, small enough for the scratch to stay in cache
+static const int QUERY_BATCH = 256;
+
+size_t Substrate::weight_count() const {
+    size_t count = 0;
+    for (int l = 0; l + 1 < layer_count(); l++) count += (size_t)layer_size(l) * layer_size(l + 1);
+    return count;
+}
+
+void SubstrateNetwork::build(const Substrate &substrate, const Network* cppn){
+    NEAT_TRACE_SCOPE("build_substrate", "inference");
+    int hidden_function = Network::activation_code(cppn->hidden_func_str);
+    int output_function = Network::activation_code(cppn->output_func_str);
+    int node_count = cppn->compiled_kind.size();
+
+    std::vector<float> query_inputs((Substrate::CPPN_INPUTS + 1) * QUERY_BATCH);
+    std::vector<float> query_outputs(Substrate::CPPN_OUTPUTS * QUERY_BATCH);
+    std::vector<float> scratch((size_t)node_count * QUERY_BATCH);
+
+    //Runs count queries, fill(b, x1, y1, x2, y2) sets query b. Inputs are stored input major with a stride of count
+    auto run_queries = [&](int count, auto fill) {
+        float* x1 = query_inputs.data();
+        float* y1 = x1 + count;
+        float* x2 = y1 + count;
+        float* y2 = x2 + count;
+        float* bias = y2 + count;
+        for (int b = 0; b < count; b++){
+            fill(b, x1[b], y1[b], x2[b], y2[b]);
+            bias[b] = 1.0f;
+        }
+        compiled_network::evaluate_batch(node_count, cppn->compiled_kind.data(), cppn->compiled_io_index.data(), cppn->compiled_edge_start.data(), cppn->compiled_edge_to.data(),
+                                         cppn->compiled_edge_weight.data(), Substrate::CPPN_OUTPUTS, hidden_function, output_function, count, query_inputs.data(),
+                                         query_outputs.data(), scratch.data());
+    };
+
+    float threshold = substrate.weight_threshold;
+    float scale = substrate.max_weight / std::max(1.0f - threshold, 0.0001f);
+
+    int pairs = substrate.layer_count() - 1;
+    this->weights.resize(pairs);
+    this->biases.resize(pairs);
+    for (int l = 0; l < pairs; l++){
+        const std::vector<float> &sources = substrate.positions[l];
+        const std::vector<float> &targets = substrate.positions[l + 1];
+        int target_count = substrate.layer_size(l + 1);
+        int64_t total = (int64_t)substrate.layer_size(l) * target_count;
+        this->weights[l].resize(total);
+        this->biases[l].resize(target_count);
+
+        for (int64_t start = 0; start < total; start += QUERY_BATCH){
+            int count = (int)std::min<int64_t>(QUERY_BATCH, total - start);
+            run_queries(count, [&](int b, float &x1, float &y1, float &x2, float &y2) {
+                int64_t query = start + b;
+                int64_t source = query / target_count;
+                int64_t target = query % target_count;
+                x1 = sources[2 * source];
+                y1 = sources[2 * source + 1];
+                x2 = targets[2 * target];
+                y2 = targets[2 * target + 1];
+            });
+
+            //Outputs below the threshold are cut, the rest are rescaled to (0, max_weight] keeping their sign
+            float* weights = this->weights[l].data() + start;
+            for (int b = 0; b < count; b++){
+                float value = query_outputs[b];
+                float magnitude = std::fabs(value);
+                float scaled = std::copysign((magnitude - threshold) * scale, value);
+                weights[b] = (magnitude > threshold) ? scaled : 0.0f;
+            }
+        }
+
+        for (int start = 0; start < target_count; start += QUERY_BATCH){
+            int count = std::min(QUERY_BATCH, target_count - start);
+            run_queries(count, [&](int b, float &x1, float &y1, float &x2, float &y2) {
+                x1 = 0.0f;
+                y1 = 0.0f;
+                x2 = targets[2 * (start + b)];
+                y2 = targets[2 * (start + b) + 1];
+            });
+            const float* bias_outputs = query_outputs.data() + count; //Second output
+            for (int b = 0; b < count; b++) this->biases[l][start + b] = bias_outputs[b] * substrate.max_weight;
+        }
+    }
+}
+
+void SubstrateNetwork::evaluate(const Substrate &substrate, const float* inputs, float* outputs, std::vector<float> &scratch) const {
+    int widest = 0;
+    for (int l = 0; l < substrate.layer_count(); l++) widest = std::max(widest, substrate.layer_size(l));
+    if (scratch.size() < 2 * (size_t)widest) scratch.resize(2 * (size_t)widest);
+    float* current = scratch.data();
+    float* next = scratch.data() + widest;
+
+    std::copy(inputs, inputs + substrate.input_count(), current);
+    for (int l = 0; l + 1 < substrate.layer_count(); l++){
+        int source_count = substrate.layer_size(l);
+        int target_count = substrate.layer_size(l + 1);
+        std::copy(this->biases[l].begin(), this->biases[l].end(), next);
+
+        //Each source adds its whole row at once. Sensor grids are mostly zeros, those rows are skipped
+        const float* row = this->weights[l].data();
+        for (int s = 0; s < source_count; s++, row += target_count){
+            float value = current[s];
+            if (value == 0.0f) continue;
+            for (int t = 0; t < target_count; t++) next[t] += value * row[t];
+        }
+
+        bool last = (l + 2 == substrate.layer_count());
+        compiled_network::activation_batch(next, target_count, last ? substrate.output_function : substrate.hidden_function);
+        std::swap(current, next);
+    }
+    std::copy(current, current + substrate.output_count(), outputs);
+}
+
+size_t SubstrateNetwork::get_memory_usage() const {
+    return sizeof(SubstrateNetwork) + memory_usage::nested_vector_bytes(this->weights) + memory_usage::nested_vector_bytes(this->biases);
+}
@@ -0,0 +1,43 @@
+#ifndef SUBSTRATE_H
+#define SUBSTRATE_H
+
+#include <vector>
+#include <cstddef>
+
+struct Network;
+
+//HyperNEAT substrate (see NEATAgent.set_substrate). Layers of node positions, inputs first and outputs last, each layer fully
+//connected to the next. Evolved networks are CPPNs that give the weight between two nodes from their positions
+struct Substrate {
+    std::vector<std::vector<float>> positions; //x, y of every node in each layer
+    int hidden_function = 3;
+    int output_function = 3;
+    float weight_threshold = 0.2f; //CPPN outputs closer to 0 than this leave the connection out
+    float max_weight = 3.0f;
+
+    //CPPN inputs are x1, y1, x2, y2 and the bias. Outputs are the connection weight and the bias of the target node,
+    //which is queried with the source at the origin
+    static const int CPPN_INPUTS = 4;
+    static const int CPPN_OUTPUTS = 2;
+
+    int layer_count() const { return (int)this->positions.size(); }
+    int layer_size(int layer) const { return (int)this->positions[layer].size() / 2; }
+    int input_count() const { return layer_size(0); }
+    int output_count() const { return layer_size(layer_count() - 1); }
+    size_t weight_count() const;
+};
+
+//Dense network realized from one CPPN over a substrate
+struct SubstrateNetwork {
+    //Per layer pair, source major so evaluation walks each source's row of targets: weights[l][source * targets + target]
+    std::vector<std::vector<float>> weights;
+    std::vector<std::vector<float>> biases;
+
+    //cppn must be compiled (see Network::compile_live_network). Queries go through the CPPN in batches
+    void build(const Substrate &substrate, const Network* cppn);
+    //scratch is resized as needed, keep it around between calls
+    void evaluate(const Substrate &substrate, const float* inputs, float* outputs, std::vector<float> &scratch) const;
+    size_t get_memory_usage() const;
+};
+
+#endif
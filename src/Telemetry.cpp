@@ -0,0 +1,65 @@
+#include "Telemetry.h"
+#include <cstring>
+
+TelemetryRing::TelemetryRing(size_t capacity) : slots(new Slot[capacity]), capacity(capacity) {}
+
+void TelemetryRing::push(const TelemetryRecord &record){
+    uint64_t index = this->write_count.load(std::memory_order_relaxed);
+    Slot &slot = this->slots[index % this->capacity];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    uint32_t words[RECORD_WORDS];
+    std::memcpy(words, &record, sizeof(words));
+    for (size_t i = 0; i < RECORD_WORDS; i++) slot.words[i].store(words[i], std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+    this->write_count.store(index + 1, std::memory_order_release);
+}
+
+size_t TelemetryRing::drain(std::vector<TelemetryRecord> &out, size_t max_records){
+    size_t taken = 0;
+    while (max_records == 0 || taken < max_records){
+        uint64_t read = this->read_count.load(std::memory_order_acquire);
+        uint64_t written = this->write_count.load(std::memory_order_acquire);
+        if (read >= written) break;
+
+        //Skip whatever the producer already lapped
+        if (written - read > this->capacity){
+            uint64_t oldest = written - this->capacity;
+            if (this->read_count.compare_exchange_weak(read, oldest, std::memory_order_acq_rel)) this->dropped.fetch_add(oldest - read, std::memory_order_relaxed);
+            continue;
+        }
+
+        //Copy the slot, then check it wasnt rewritten while copying
+        const Slot &slot = this->slots[read % this->capacity];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        uint32_t words[RECORD_WORDS];
+        for (size_t i = 0; i < RECORD_WORDS; i++) words[i] = slot.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+        if (before != 2 * read + 2 || after != before) continue;
+
+        //Claim it, another reader may have got there first
+        if (!this->read_count.compare_exchange_weak(read, read + 1, std::memory_order_acq_rel)) continue;
+        out.emplace_back();
+        std::memcpy(&out.back(), words, sizeof(words));
+        taken++;
+    }
+    return taken;
+}
+
+size_t TelemetryRing::available() const {
+    uint64_t read = this->read_count.load(std::memory_order_acquire);
+    uint64_t written = this->write_count.load(std::memory_order_acquire);
+    if (written <= read) return 0;
+    return (written - read > this->capacity) ? this->capacity : written - read;
+}
+
+uint64_t TelemetryRing::get_dropped() const {
+    return this->dropped.load(std::memory_order_relaxed);
+}
+
+size_t TelemetryRing::get_capacity() const {
+    return this->capacity;
+}
@@ -0,0 +1,65 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//Stats for one evaluated generation, fixed size so the ring never allocates
+struct TelemetryRecord {
+    int64_t generation = 0;
+    int32_t population_size = 0;
+    int32_t species_count = 0;
+    float compatibility_threshold = 0.0f;
+    float champion_fitness = 0.0f;
+
+    float fitness_min = 0.0f;
+    float fitness_p25 = 0.0f;
+    float fitness_median = 0.0f;
+    float fitness_p75 = 0.0f;
+    float fitness_max = 0.0f;
+    float fitness_mean = 0.0f;
+    float fitness_stddev = 0.0f;
+
+    int32_t species_size_min = 0;
+    int32_t species_size_max = 0;
+    float species_size_mean = 0.0f;
+
+    float active_connections_mean = 0.0f;
+    int32_t active_connections_max = 0;
+    float hidden_neurons_mean = 0.0f;
+    int32_t hidden_neurons_max = 0;
+};
+
+//Single producer ring of TelemetryRecords. The evolution loop pushes without locks or allocation, and any number of threads
+//can drain. Each slot carries a seqlock style sequence (odd while being written) so a reader never returns a record that was
+//overwritten under it. When readers fall behind the oldest records are overwritten and counted as dropped
+static_assert(sizeof(TelemetryRecord) % sizeof(uint32_t) == 0, "TelemetryRecord must be a whole number of 32 bit words");
+
+struct TelemetryRing {
+    //The record is held as relaxed atomic words so a reader copying it while it is rewritten is a detected retry, not a data race
+    static const size_t RECORD_WORDS = sizeof(TelemetryRecord) / sizeof(uint32_t);
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint32_t> words[RECORD_WORDS];
+    };
+
+    explicit TelemetryRing(size_t capacity);
+
+    void push(const TelemetryRecord &record); //Producer thread only
+    size_t drain(std::vector<TelemetryRecord> &out, size_t max_records); //NOTE: 0 means every available record
+    size_t available() const;
+    uint64_t get_dropped() const;
+    size_t get_capacity() const;
+
+private:
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    std::atomic<uint64_t> write_count{0};
+    std::atomic<uint64_t> read_count{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+#endif
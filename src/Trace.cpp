@@ -0,0 +1,158 @@
+#include "Trace.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trace {
+    std::atomic<bool> active{false};
+
+    struct Event {
+        const char* name;
+        const char* category;
+        int64_t start_ns;
+        int64_t end_ns;
+    };
+
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::vector<Event> events;
+        int thread_id = 0;
+        uint64_t session = 0;
+        bool named = false; //Writer thread only
+    };
+
+    //Flush early once a thread has this many events waiting
+    const size_t FLUSH_EVENTS = 8192;
+    const int FLUSH_INTERVAL_MS = 200;
+
+    static std::mutex session_mutex; //Guards everything below except the per buffer event lists
+    static std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    static std::atomic<uint64_t> session{0};
+    static std::chrono::steady_clock::time_point session_start;
+    static FILE* file = nullptr;
+    static bool first_event = true;
+    static std::thread writer;
+    static std::condition_variable wake_writer;
+    static bool stopping = false;
+
+    static thread_local std::shared_ptr<ThreadBuffer> local_buffer;
+
+    int64_t now_ns(){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static ThreadBuffer* get_local_buffer(){
+        uint64_t current = session.load(std::memory_order_acquire);
+        if (local_buffer != nullptr && local_buffer->session == current) return local_buffer.get();
+
+        //First event from this thread in this session
+        std::lock_guard<std::mutex> lock(session_mutex);
+        local_buffer = std::make_shared<ThreadBuffer>();
+        local_buffer->session = current;
+        local_buffer->thread_id = buffers.size() + 1;
+        local_buffer->events.reserve(1024);
+        buffers.push_back(local_buffer);
+        return local_buffer.get();
+    }
+
+    void record(const char* name, const char* category, int64_t start_ns, int64_t end_ns){
+        ThreadBuffer* buffer = get_local_buffer();
+        size_t waiting;
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->events.push_back({name, category, start_ns, end_ns});
+            waiting = buffer->events.size();
+        }
+        if (waiting == FLUSH_EVENTS) wake_writer.notify_one();
+    }
+
+    static void write_separator(){
+        fputs(first_event ? "\n" : ",\n", file);
+        first_event = false;
+    }
+
+    //Writer thread (or stop once the writer is gone). Takes each buffer's events with a swap so threads only wait on a pointer exchange
+    static void flush_buffers(std::vector<std::shared_ptr<ThreadBuffer>> &snapshot, std::vector<Event> &taken){
+        int64_t origin = std::chrono::duration_cast<std::chrono::nanoseconds>(session_start.time_since_epoch()).count();
+        for (std::shared_ptr<ThreadBuffer> &buffer : snapshot){
+            taken.clear();
+            {
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+                taken.swap(buffer->events);
+            }
+            if (!buffer->named){
+                write_separator();
+                fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", buffer->thread_id, buffer->thread_id);
+                buffer->named = true;
+            }
+            for (const Event &e : taken){
+                write_separator();
+                fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        e.name, e.category, buffer->thread_id, (e.start_ns - origin) / 1000.0, (e.end_ns - e.start_ns) / 1000.0);
+            }
+        }
+        fflush(file);
+    }
+
+    static void writer_loop(){
+        std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+        std::vector<Event> taken;
+        std::unique_lock<std::mutex> lock(session_mutex);
+        while (true){
+            wake_writer.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+            bool last = stopping;
+
+            //Write without holding the session lock so new threads can still register
+            snapshot = buffers;
+            lock.unlock();
+            flush_buffers(snapshot, taken);
+            lock.lock();
+
+            if (last) break;
+        }
+    }
+
+    bool start(const std::string &path, std::string &error){
+        stop();
+
+        FILE* new_file = fopen(path.c_str(), "w");
+        if (new_file == nullptr){
+            error = "Could not open trace file " + path;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(session_mutex);
+        file = new_file;
+        fputs("[", file);
+        first_event = true;
+        stopping = false;
+        buffers.clear();
+        session_start = std::chrono::steady_clock::now();
+        session.fetch_add(1, std::memory_order_release);
+        writer = std::thread(writer_loop);
+        active.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void stop(){ //NOTE: Call start and stop from one thread at a time
+        active.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(session_mutex);
+            if (file == nullptr) return;
+            stopping = true;
+        }
+        wake_writer.notify_one();
+        writer.join();
+
+        //Scopes still open when tracing stopped record into buffers nobody flushes, and go with them
+        std::lock_guard<std::mutex> lock(session_mutex);
+        fputs("\n]\n", file);
+        fclose(file);
+        file = nullptr;
+        buffers.clear();
+    }
+}
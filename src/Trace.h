@@ -0,0 +1,42 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+//Chrome / Perfetto trace-event output (chrome://tracing or ui.perfetto.dev open the file). Every thread appends complete
+//events to its own buffer and a background thread writes them out, so a traced scope costs a clock read and an
+//uncontended lock. With no trace running a scope is a single relaxed load.
+//Names and categories must be string literals, only the pointers are stored
+namespace trace {
+    extern std::atomic<bool> active;
+
+    bool start(const std::string &path, std::string &error);
+    void stop();
+    int64_t now_ns();
+    void record(const char* name, const char* category, int64_t start_ns, int64_t end_ns);
+
+    inline bool is_active(){
+        return active.load(std::memory_order_relaxed);
+    }
+
+    struct Scope {
+        const char* name;
+        const char* category;
+        int64_t start_ns = -1;
+
+        Scope(const char* name, const char* category) : name(name), category(category) {
+            if (is_active()) this->start_ns = now_ns();
+        }
+        ~Scope(){
+            if (this->start_ns >= 0) record(this->name, this->category, this->start_ns, now_ns());
+        }
+    };
+}
+
+#define NEAT_TRACE_CONCAT_INNER(a, b) a##b
+#define NEAT_TRACE_CONCAT(a, b) NEAT_TRACE_CONCAT_INNER(a, b)
+#define NEAT_TRACE_SCOPE(name, category) trace::Scope NEAT_TRACE_CONCAT(trace_scope_, __LINE__)(name, category)
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef WORKERPROTOCOL_H
+#define WORKERPROTOCOL_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "CompiledNetwork.h"
+
+//Wire format between NEATAgent and out of process evaluation workers. Plain C++ so worker programs can include it without godot-cpp.
+//Host -> worker: MessageHeader followed by payload_size bytes (an encoded network for MESSAGE_EVALUATE, nothing for MESSAGE_SHUTDOWN)
+//Worker -> host: ResultMessage for every MESSAGE_EVALUATE, in any order
+//Both ends share a machine so values are sent in native byte order
+namespace worker_protocol {
+    const uint32_t MAGIC = 0x5741454E; //"NEAW"
+    const uint32_t MESSAGE_EVALUATE = 1;
+    const uint32_t MESSAGE_SHUTDOWN = 2;
+
+    struct MessageHeader {
+        uint32_t magic;
+        uint32_t type;
+        uint32_t job_id;
+        uint32_t payload_size;
+    };
+
+    struct ResultMessage {
+        uint32_t job_id;
+        float fitness;
+    };
+
+    //Encoded network is the compiled inference path of a Network:
+    //int32 inputs, outputs, hidden_function, output_function, node_count, edge_count
+    //int32 kind[node_count], int32 io_index[node_count], int32 edge_start[node_count + 1]
+    //int32 edge_to[edge_count], float edge_weight[edge_count]
+    //Kinds are 0 input, 1 hidden, 2 output. Functions are 0 relu, 1 linear, 2 sigmoid, 3 tanh (same as extract_champion_data)
+    struct EncodedNetwork {
+        int32_t inputs = 0;
+        int32_t outputs = 0;
+        int32_t hidden_function = 0;
+        int32_t output_function = 0;
+        std::vector<int32_t> kind;
+        std::vector<int32_t> io_index;
+        std::vector<int32_t> edge_start;
+        std::vector<int32_t> edge_to;
+        std::vector<float> edge_weight;
+    };
+
+    inline void append_raw(std::vector<uint8_t> &buffer, const void* data, size_t size){
+        const uint8_t* bytes = (const uint8_t*)data;
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    inline void encode_network(std::vector<uint8_t> &buffer, const EncodedNetwork &network){
+        int32_t fields[6] = {network.inputs, network.outputs, network.hidden_function, network.output_function, (int32_t)network.kind.size(), (int32_t)network.edge_to.size()};
+        append_raw(buffer, fields, sizeof(fields));
+        append_raw(buffer, network.kind.data(), network.kind.size() * sizeof(int32_t));
+        append_raw(buffer, network.io_index.data(), network.io_index.size() * sizeof(int32_t));
+        append_raw(buffer, network.edge_start.data(), network.edge_start.size() * sizeof(int32_t));
+        append_raw(buffer, network.edge_to.data(), network.edge_to.size() * sizeof(int32_t));
+        append_raw(buffer, network.edge_weight.data(), network.edge_weight.size() * sizeof(float));
+    }
+
+    //Returns false if the payload is truncated or inconsistent
+    inline bool decode_network(const uint8_t* data, size_t size, EncodedNetwork &network){
+        size_t offset = 0;
+        auto read = [&](void* out, size_t bytes) {
+            if (offset + bytes > size) return false;
+            if (bytes > 0) memcpy(out, data + offset, bytes);
+            offset += bytes;
+            return true;
+        };
+
+        int32_t fields[6];
+        if (!read(fields, sizeof(fields))) return false;
+        network.inputs = fields[0];
+        network.outputs = fields[1];
+        network.hidden_function = fields[2];
+        network.output_function = fields[3];
+        int32_t node_count = fields[4];
+        int32_t edge_count = fields[5];
+        if (node_count < 0 || edge_count < 0) return false;
+
+        network.kind.resize(node_count);
+        network.io_index.resize(node_count);
+        network.edge_start.resize(node_count + 1);
+        network.edge_to.resize(edge_count);
+        network.edge_weight.resize(edge_count);
+        if (!read(network.kind.data(), node_count * sizeof(int32_t))) return false;
+        if (!read(network.io_index.data(), node_count * sizeof(int32_t))) return false;
+        if (!read(network.edge_start.data(), (node_count + 1) * sizeof(int32_t))) return false;
+        if (!read(network.edge_to.data(), edge_count * sizeof(int32_t))) return false;
+        if (!read(network.edge_weight.data(), edge_count * sizeof(float))) return false;
+
+        for (int i = 0; i < node_count; i++){
+            if (network.edge_start[i] < 0 || network.edge_start[i] > network.edge_start[i + 1] || network.edge_start[i + 1] > edge_count) return false;
+            if (network.kind[i] == 0 && (network.io_index[i] < 0 || network.io_index[i] >= network.inputs)) return false;
+            if (network.kind[i] == 2 && (network.io_index[i] < 0 || network.io_index[i] >= network.outputs)) return false;
+        }
+        for (int32_t to : network.edge_to){
+            if (to < 0 || to >= node_count) return false;
+        }
+        return true;
+    }
+
+    //Same evaluation as Network::guess. inputs must include the trailing bias input of 1.0
+    inline void evaluate(const EncodedNetwork &network, const float* inputs, float* outputs, std::vector<float> &scratch){
+        scratch.resize(network.kind.size());
+        compiled_network::evaluate(network.kind.size(), network.kind.data(), network.io_index.data(), network.edge_start.data(), network.edge_to.data(), network.edge_weight.data(),
+                                   network.outputs, network.hidden_function, network.output_function, inputs, outputs, scratch.data());
+    }
+}
+
+#endif
@@ -1,12 +1,20 @@
 #include "register_types.h"
 #include "NEATAgent.h"
 #include "NetworkAgent.h"
+#include "NEATSweep.h"
+#include "ChampionLogReader.h"
+#include "NEATModel.h"
 #include <gdextension_interface.h>
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
+#include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/classes/resource_saver.hpp>
 
 using namespace godot;
 
+static Ref<ResourceFormatLoaderNEATModel> model_loader;
+static Ref<ResourceFormatSaverNEATModel> model_saver;
+
 void initialize_neat(ModuleInitializationLevel p_level){
     if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE){
         return;
@@ -14,12 +22,27 @@ void initialize_neat(ModuleInitializationLevel p_level){
 
     ClassDB::register_class<NEATAgent>();
     ClassDB::register_class<NetworkAgent>();
+    ClassDB::register_class<NEATSweep>();
+    ClassDB::register_class<ChampionLogReader>();
+    ClassDB::register_class<NEATModel>();
+    ClassDB::register_class<ResourceFormatLoaderNEATModel>();
+    ClassDB::register_class<ResourceFormatSaverNEATModel>();
+
+    model_loader.instantiate();
+    ResourceLoader::get_singleton()->add_resource_format_loader(model_loader);
+    model_saver.instantiate();
+    ResourceSaver::get_singleton()->add_resource_format_saver(model_saver);
 }
 
 void uninitialize_neat(ModuleInitializationLevel p_level){
     if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE){
         return;
     }
+
+    ResourceLoader::get_singleton()->remove_resource_format_loader(model_loader);
+    model_loader.unref();
+    ResourceSaver::get_singleton()->remove_resource_format_saver(model_saver);
+    model_saver.unref();
 }
 
 extern "C"{
@@ -0,0 +1,91 @@
+//Stand-in evaluation worker for NEATAgent.start_evaluation_workers. Real workers run a simulation instead of evaluate_fitness
+//but speak the same protocol (src/WorkerProtocol.h): networks arrive on stdin, fitness values leave on stdout.
+//Options for testing failure handling:
+//  --delay-ms N      sleep N milliseconds per network
+//  --crash-after N   exit without answering the Nth network
+//  --hang-after N    stop answering from the Nth network on
+
+#include "../src/WorkerProtocol.h"
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static bool read_exact(void* out, size_t size){
+    uint8_t* bytes = (uint8_t*)out;
+    while (size > 0){
+        ssize_t got = read(0, bytes, size);
+        if (got <= 0) return false;
+        bytes += got;
+        size -= got;
+    }
+    return true;
+}
+
+static bool write_all(const void* data, size_t size){
+    const uint8_t* bytes = (const uint8_t*)data;
+    while (size > 0){
+        ssize_t sent = write(1, bytes, size);
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+//How closely the network follows 0.5 + 0.4 * sin(sum of inputs) on 16 fixed samples
+static float evaluate_fitness(const worker_protocol::EncodedNetwork &network){
+    std::vector<float> inputs(network.inputs);
+    std::vector<float> outputs(network.outputs);
+    std::vector<float> scratch;
+    float error = 0.0f;
+
+    for (int sample = 0; sample < 16; sample++){
+        float sum = 0.0f;
+        for (int i = 0; i < network.inputs - 1; i++){
+            inputs[i] = sinf(sample * 0.37f + i * 1.3f);
+            sum += inputs[i];
+        }
+        inputs[network.inputs - 1] = 1.0f; //Bias
+
+        worker_protocol::evaluate(network, inputs.data(), outputs.data(), scratch);
+        float target = 0.5f + 0.4f * sinf(sum);
+        for (float output : outputs) error += (output - target) * (output - target);
+    }
+    return 1.0f / (1.0f + error / 16.0f);
+}
+
+int main(int argc, char** argv){
+    int delay_ms = 0;
+    long crash_after = -1;
+    long hang_after = -1;
+    for (int i = 1; i + 1 < argc; i++){
+        if (strcmp(argv[i], "--delay-ms") == 0) delay_ms = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--crash-after") == 0) crash_after = atol(argv[++i]);
+        else if (strcmp(argv[i], "--hang-after") == 0) hang_after = atol(argv[++i]);
+    }
+
+    std::vector<uint8_t> payload;
+    worker_protocol::EncodedNetwork network;
+    long handled = 0;
+
+    while (true){
+        worker_protocol::MessageHeader header;
+        if (!read_exact(&header, sizeof(header))) return 0;
+        if (header.magic != worker_protocol::MAGIC) return 1;
+        if (header.type == worker_protocol::MESSAGE_SHUTDOWN) return 0;
+
+        payload.resize(header.payload_size);
+        if (!read_exact(payload.data(), payload.size())) return 0;
+
+        handled++;
+        if (handled == crash_after) _exit(3);
+        if (hang_after >= 0 && handled >= hang_after) pause();
+        if (delay_ms > 0) usleep(delay_ms * 1000);
+
+        worker_protocol::ResultMessage result;
+        result.job_id = header.job_id;
+        result.fitness = worker_protocol::decode_network(payload.data(), payload.size(), network) ? evaluate_fitness(network) : NAN;
+        if (!write_all(&result, sizeof(result))) return 0;
+    }
+}